@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QChar>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QScopeGuard>
+#include <QStandardPaths>
+#include <QTest>
+#include <QThread>
+
+#include <algorithm>
+#include <vector>
+
+#include "config/appconfig.h"
+#include "config/configkeys.h"
+#include "core/accentmap.h"
+#include "core/composeaccents.h"
+#include "core/customaccents.h"
+#include "core/keystatemachine.h"
+#include "core/singleinstance.h"
+#include "accenttables.h"
+
+namespace
+{
+constexpr int SpaceKeycode = 65;
+
+// Median round trip of a command to the running instance, in microseconds
+constexpr qint64 RoundTripTarget = 1000;
+
+struct KeyEvent {
+    int keycode;
+    char32_t character;
+    bool pressed;
+};
+
+// Typed text with a hold and trigger after every few words; keycodes are
+// made up but stable per character
+std::vector<KeyEvent> typingSession(int count)
+{
+    const QString text = QStringLiteral("the quick brown fox jumps over the lazy dog while a café owner naïvely waits ");
+
+    std::vector<KeyEvent> events;
+    events.reserve(count);
+
+    int words = 0;
+    for (int i = 0; static_cast<int>(events.size()) < count; ++i) {
+        const QChar c = text[i % text.size()];
+        const int keycode = c == u' ' ? SpaceKeycode : 10 + c.unicode() % 80;
+
+        if (c == u' ' && ++words % 4 == 0) {
+            // Holds the previous letter and presses Space under it
+            const QChar held = text[(i + text.size() - 1) % text.size()];
+            const int heldKeycode = 10 + held.unicode() % 80;
+            events.push_back({heldKeycode, held.unicode(), true});
+            events.push_back({SpaceKeycode, U' ', true});
+            events.push_back({SpaceKeycode, U' ', false});
+            events.push_back({heldKeycode, held.unicode(), false});
+        }
+
+        events.push_back({keycode, c.unicode(), true});
+        events.push_back({keycode, c.unicode(), false});
+    }
+
+    events.resize(count);
+    return events;
+}
+}
+
+/*
+ * Microbenchmarks of the GUI-free parts: candidate lookup for every base
+ * and set, the key state machine, settings reads and the instance
+ * socket. Built with
+ * -DACCENTPICKER_BUILD_BENCH=ON; run e.g. with -tickcounter or -iterations.
+ */
+class AccentPickerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void lookup_data();
+    void lookup();
+
+    void stateMachine();
+
+    void configGet();
+    void configSnapshot();
+    void selectedLanguages();
+
+    void instanceRoundTrip();
+};
+
+void AccentPickerBench::initTestCase()
+{
+    // Default settings and fresh caches instead of the user's
+    QCoreApplication::setOrganizationName("HBatalha");
+    QCoreApplication::setApplicationName("Accent Picker Bench");
+    QStandardPaths::setTestModeEnabled(true);
+
+    composeAccents->load();
+    customAccents->load();
+}
+
+void AccentPickerBench::lookup_data()
+{
+    QTest::addColumn<LanguageMask>("mask");
+    QTest::addColumn<bool>("cached");
+
+    const QList<LanguageInfo> languages = AccentMap::getAllLanguages();
+    for (const bool cached : {false, true}) {
+        for (const LanguageInfo &language : languages) {
+            const LanguageMask mask = language.language == Language::ALL ? AllLanguagesMask
+                                      : languageBit(language.language);
+            QTest::addRow("%s %s", qPrintable(language.code), cached ? "cached" : "cold") << mask << cached;
+        }
+    }
+}
+
+// Every base in both cases under one set mask
+void AccentPickerBench::lookup()
+{
+    QFETCH(LanguageMask, mask);
+    QFETCH(bool, cached);
+
+    qsizetype candidates = 0;
+
+    QBENCHMARK {
+        if (!cached) {
+            AccentMap::clearCache();
+        }
+
+        for (char32_t base : AccentTables::bases) {
+            candidates += AccentMap::getAccents(base, mask).size();
+            candidates += AccentMap::getAccents(QChar::toUpper(base), mask).size();
+        }
+    }
+
+    QVERIFY(candidates >= 0);
+}
+
+// One iteration is EventCount key events
+void AccentPickerBench::stateMachine()
+{
+    constexpr int EventCount = 1000000;
+    const std::vector<KeyEvent> events = typingSession(EventCount);
+
+    KeyStateMachine state;
+    state.setSpaceKeycode(SpaceKeycode);
+
+    int triggers = 0;
+
+    QBENCHMARK {
+        for (const KeyEvent &event : events) {
+            const KeyStateMachine::Actions actions = event.pressed ? state.keyPressed(event.keycode, event.character)
+                                                     : state.keyReleased(event.keycode);
+            if (actions & KeyStateMachine::StartDwell) {
+                state.dwellElapsed();
+            }
+            if (actions & KeyStateMachine::Trigger) {
+                ++triggers;
+            }
+        }
+    }
+
+    QVERIFY(triggers > 0);
+}
+
+void AccentPickerBench::configGet()
+{
+    int active = 0;
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            active += appConfig->get<ConfigKey::Active>();
+        }
+    }
+
+    QVERIFY(active >= 0);
+}
+
+void AccentPickerBench::configSnapshot()
+{
+    qsizetype sets = 0;
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            const auto config = appConfig->snapshot();
+            sets += config->get<ConfigKey::SelectedCharacterSets>().size();
+        }
+    }
+
+    QVERIFY(sets >= 0);
+}
+
+void AccentPickerBench::selectedLanguages()
+{
+    LanguageMask mask = 0;
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            mask |= AccentMap::selectedLanguages();
+        }
+    }
+
+    QCOMPARE(mask, AccentMap::selectedLanguages());
+}
+
+// A command sent to a server on its own thread, as by a second launch
+// or --ctl; each send connects anew
+void AccentPickerBench::instanceRoundTrip()
+{
+    const QString key = QStringLiteral("accentpicker-bench-%1").arg(QCoreApplication::applicationPid());
+
+    QThread server;
+    auto *instance = new SingleInstance(key);
+    instance->setHandler([](const QByteArray &) {
+        return QByteArray("ok");
+    });
+    instance->moveToThread(&server);
+    connect(&server, &QThread::finished, instance, &QObject::deleteLater);
+    server.start();
+    const auto stop = qScopeGuard([&server]() {
+        server.quit();
+        server.wait();
+    });
+
+    bool listening = false;
+    QMetaObject::invokeMethod(instance, [instance, &listening]() {
+        listening = instance->run();
+    }, Qt::BlockingQueuedConnection);
+    QVERIFY(listening);
+
+    QBENCHMARK {
+        QVERIFY(SingleInstance::send(key, {"ping"}));
+    }
+
+    constexpr int SampleCount = 1000;
+    std::vector<qint64> samples;
+    samples.reserve(SampleCount);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < SampleCount; ++i) {
+        timer.start();
+        const auto replies = SingleInstance::send(key, {"ping"});
+        samples.push_back(timer.nsecsElapsed() / 1000);
+        QVERIFY(replies);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const qint64 median = samples[samples.size() / 2];
+    const qint64 p99 = samples[samples.size() * 99 / 100];
+    qInfo("round trip median %lld us, p99 %lld us, target %lld us", median, p99, RoundTripTarget);
+
+    QVERIFY2(median < RoundTripTarget, "median round trip above the target");
+}
+
+QTEST_GUILESS_MAIN(AccentPickerBench)
+
+#include "accentpickerbench.moc"
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QImage>
+#include <QLabel>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "core/accentmap.h"
+#include "gui/accentpicker.h"
+#include "gui/accentstrip.h"
+#include "gui/accentstriprenderer.h"
+#include "gui/widgetaccentpopup.h"
+#include "platform/x11/x11accentpopup.h"
+#include "allocationcounter.h"
+
+namespace
+{
+// Enough candidates for a few rows of the grid
+QStringList candidates()
+{
+    QStringList accents;
+    for (const char32_t base : {U'a', U'e', U'o'}) {
+        accents += AccentMap::getAccents(base, AllLanguagesMask);
+    }
+    return accents;
+}
+
+// The candidate bar before AccentStrip: a label per candidate, restyled
+// through its style sheet when the selection moves
+QString labelStyle(bool highlighted)
+{
+    return QString("QLabel {"
+                   "    background-color: %1;"
+                   "    color: %2;"
+                   "    border-radius: 6px;"
+                   "    font-size: 20px;"
+                   "    font-weight: bold;"
+                   "    padding: 8px;"
+                   "}").arg(QLatin1String(highlighted ? "#4A90E2" : "#2C2C2C"),
+                           QLatin1String(highlighted ? "#FFFFFF" : "#CCCCCC"));
+}
+
+// nullptr when the backend cannot run here
+AccentPopup* createPopup(const QString &backend)
+{
+    if (backend == QLatin1String("x11")) {
+        if (QGuiApplication::platformName() != QLatin1String("xcb")) {
+            return nullptr;
+        }
+        return X11AccentPopup::create();
+    }
+
+    return new WidgetAccentPopup;
+}
+}
+
+/*
+ * Benchmarks of the popup: a show, three moves of the selection and a
+ * hide through AccentPicker for each backend with the allocations of a
+ * show, and a selection move on the candidate strip next to the same
+ * move on the style sheet labels it replaced. Built with -DACCENTPICKER_BUILD_BENCH=ON; needs a
+ * display, the X11 backend is skipped on other platforms.
+ */
+class PopupBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void showNavigateHide_data();
+    void showNavigateHide();
+
+    void showAllocations_data();
+    void showAllocations();
+
+    void selectionRender();
+    void selectionWidget();
+    void selectionStyleSheet();
+};
+
+void PopupBench::initTestCase()
+{
+    // Default settings and fresh caches instead of the user's
+    QCoreApplication::setOrganizationName("HBatalha");
+    QCoreApplication::setApplicationName("Accent Picker Bench");
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void PopupBench::showNavigateHide_data()
+{
+    QTest::addColumn<QString>("backend");
+
+    QTest::newRow("widget") << QStringLiteral("widget");
+    QTest::newRow("x11") << QStringLiteral("x11");
+}
+
+void PopupBench::showNavigateHide()
+{
+    QFETCH(QString, backend);
+
+    AccentPopup *popup = createPopup(backend);
+    if (!popup) {
+        QSKIP("The X11 popup needs an X display");
+    }
+
+    AccentPicker picker(popup);
+    picker.prepare();
+
+    QBENCHMARK {
+        picker.trigger(U'e');
+        QCoreApplication::processEvents();
+
+        for (int i = 0; i < 3; ++i) {
+            picker.navigate(Qt::Key_Right);
+            QCoreApplication::processEvents();
+        }
+
+        picker.hide();
+        QCoreApplication::processEvents();
+    }
+
+    QVERIFY(!picker.isVisible());
+}
+
+void PopupBench::showAllocations_data()
+{
+    showNavigateHide_data();
+}
+
+// Heap allocations of a warmed-up show and hide, the part of a trigger
+// after the key path; reported rather than held to a budget
+void PopupBench::showAllocations()
+{
+    QFETCH(QString, backend);
+
+    if (!AllocationCounter::isAvailable()) {
+        QSKIP("Allocations are only counted with glibc");
+    }
+
+    AccentPopup *popup = createPopup(backend);
+    if (!popup) {
+        QSKIP("The X11 popup needs an X display");
+    }
+
+    AccentPicker picker(popup);
+    picker.prepare();
+
+    const auto showAndHide = [&picker]() {
+        picker.trigger(U'e');
+        QCoreApplication::processEvents();
+        picker.hide();
+        QCoreApplication::processEvents();
+    };
+    showAndHide();
+
+    quint64 allocations = 0;
+    {
+        AllocationCounter counter;
+        showAndHide();
+        allocations = counter.count();
+    }
+
+    qInfo("%s popup: %llu allocations for a show and hide", qPrintable(backend), allocations);
+}
+
+// What a selection move costs on any surface: the region to repaint and
+// drawing it into an image
+void PopupBench::selectionRender()
+{
+    const QStringList accents = candidates();
+    const qreal ratio = qApp->devicePixelRatio();
+
+    AccentStripRenderer renderer;
+    renderer.setAccents(accents, ratio);
+
+    QImage surface(renderer.size() * ratio, QImage::Format_ARGB32_Premultiplied);
+    surface.setDevicePixelRatio(ratio);
+    QPainter painter(&surface);
+    renderer.paint(painter, QRect(QPoint(), renderer.size()), ratio);
+
+    int index = 0;
+    qint64 area = 0;
+
+    QBENCHMARK {
+        index = (index + 1) % accents.size();
+
+        const QRegion region = renderer.setCurrentIndex(index);
+        for (const QRect &rect : region) {
+            painter.save();
+            painter.setClipRect(rect);
+            renderer.paint(painter, rect, ratio);
+            painter.restore();
+            area += rect.width() * rect.height();
+        }
+    }
+
+    QVERIFY(area > 0);
+}
+
+// The same through AccentStrip, including the update() and paint event
+void PopupBench::selectionWidget()
+{
+    const QStringList accents = candidates();
+
+    AccentStrip strip;
+    strip.setAccents(accents);
+    strip.adjustSize();
+    strip.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&strip));
+
+    int index = 0;
+
+    QBENCHMARK {
+        index = (index + 1) % accents.size();
+        strip.setCurrentIndex(index);
+        QCoreApplication::processEvents();
+    }
+}
+
+// Baseline for selectionWidget: the same move re-polishing two labels
+void PopupBench::selectionStyleSheet()
+{
+    const QStringList accents = candidates();
+
+    QWidget bar;
+    auto *layout = new QHBoxLayout(&bar);
+    layout->setContentsMargins(8, 8, 8, 8);
+    layout->setSpacing(6);
+    bar.setStyleSheet("QWidget {"
+                      "    background-color: rgba(44, 44, 44, 240);"
+                      "    border: 1px solid #555555;"
+                      "    border-radius: 8px;"
+                      "}");
+
+    QList<QLabel*> labels;
+    for (const QString &accent : accents) {
+        auto *label = new QLabel(accent, &bar);
+        label->setAlignment(Qt::AlignCenter);
+        label->setStyleSheet(labelStyle(false));
+        layout->addWidget(label);
+        labels.append(label);
+    }
+
+    bar.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&bar));
+
+    int index = 0;
+
+    QBENCHMARK {
+        labels[index]->setStyleSheet(labelStyle(false));
+        index = (index + 1) % accents.size();
+        labels[index]->setStyleSheet(labelStyle(true));
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(PopupBench)
+
+#include "popupbench.moc"
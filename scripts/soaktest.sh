@@ -0,0 +1,118 @@
+#!/bin/bash
+# Starts one accentpicker per Xvfb display, as on a shared XRDP/Xvnc host,
+# and reports the memory and CPU used per additional session.
+#
+#   scripts/soaktest.sh [sessions] [idle seconds] [accentpicker binary]
+#
+# Memory is PSS, so pages shared between the instances (the binary, the
+# libraries and the mapped table caches) are split between them.
+#
+# Fails when the resident set of any instance, as --report-memory gives
+# it, exceeds RSS_BUDGET KiB. Exits with 77 (skipped) without Xvfb or
+# xdpyinfo.
+#
+# The default budget is not a measurement of this build. A Qt 6 Widgets
+# process with an X connection, a tray icon and D-Bus is usually 60-80 MiB
+# resident, mostly shared libraries and fonts, and 120000 KiB leaves about
+# half again on top of that. Measure an idle instance with --report-memory
+# and set ACCENTPICKER_RSS_BUDGET (CMake) or RSS_BUDGET to tighten it.
+set -e
+
+SESSIONS=${1:-8}
+IDLE=${2:-30}
+BINARY=${3:-./build/accentpicker}
+FIRST_DISPLAY=${FIRST_DISPLAY:-90}
+RSS_BUDGET=${RSS_BUDGET:-120000}
+
+for tool in Xvfb xdpyinfo; do
+    if ! command -v "$tool" >/dev/null; then
+        echo "$tool is required" >&2
+        exit 77
+    fi
+done
+
+XVFB_PIDS=()
+APP_PIDS=()
+
+cleanup() {
+    kill "${APP_PIDS[@]}" "${XVFB_PIDS[@]}" 2>/dev/null || true
+    wait 2>/dev/null || true
+}
+trap cleanup EXIT
+
+# Proportional set size and CPU ticks of a process
+pss_kib() {
+    awk '/^Pss:/ { print $2 }' "/proc/$1/smaps_rollup"
+}
+cpu_ticks() {
+    awk '{ print $14 + $15 }' "/proc/$1/stat"
+}
+# CPU share in percent of ticks spent over the idle period
+cpu_percent() {
+    awk -v ticks="$1" -v hz="$TICKS" -v seconds="$IDLE" 'BEGIN { print ticks * 100 / hz / seconds }'
+}
+
+echo "Starting $SESSIONS sessions..."
+for ((i = 0; i < SESSIONS; ++i)); do
+    display=":$((FIRST_DISPLAY + i))"
+
+    Xvfb "$display" -screen 0 1280x1024x24 +extension RECORD -nolisten tcp >/dev/null 2>&1 &
+    XVFB_PIDS+=($!)
+
+    for _ in $(seq 50); do
+        xdpyinfo -display "$display" >/dev/null 2>&1 && break
+        sleep 0.1
+    done
+
+    DISPLAY=$display QT_QPA_PLATFORM=xcb "$BINARY" >/dev/null 2>&1 &
+    APP_PIDS+=($!)
+
+    for _ in $(seq 100); do
+        DISPLAY=$display "$BINARY" --ctl ping >/dev/null 2>&1 && break
+        sleep 0.1
+    done
+
+    # What a single session costs, before any pages are shared
+    if ((i == 0)); then
+        baseline_pss=$(pss_kib "${APP_PIDS[0]}")
+    fi
+done
+
+TICKS=$(getconf CLK_TCK)
+declare -A start_ticks
+for pid in "${APP_PIDS[@]}"; do
+    start_ticks[$pid]=$(cpu_ticks "$pid")
+done
+
+echo "Idling for $IDLE s..."
+sleep "$IDLE"
+
+total_pss=0
+total_ticks=0
+over_budget=0
+for ((i = 0; i < SESSIONS; ++i)); do
+    pid=${APP_PIDS[$i]}
+    pss=$(pss_kib "$pid")
+    ticks=$(($(cpu_ticks "$pid") - start_ticks[$pid]))
+    total_pss=$((total_pss + pss))
+    total_ticks=$((total_ticks + ticks))
+
+    report=$(DISPLAY=":$((FIRST_DISPLAY + i))" "$BINARY" --report-memory 2>/dev/null || true)
+    printf "session %2d  pss %7d KiB  cpu %6.2f%%  %s\n" "$i" "$pss" \
+        "$(cpu_percent "$ticks")" "$report"
+
+    rss=$(echo "$report" | grep -o 'vmrss=[0-9]*' | cut -d= -f2)
+    if [ -z "$rss" ] || ((rss > RSS_BUDGET)); then
+        echo "session $i: resident set ${rss:-unknown} KiB, budget $RSS_BUDGET KiB" >&2
+        over_budget=1
+    fi
+done
+
+echo
+printf "total pss %d KiB, cpu while idle %.2f%%\n" "$total_pss" "$(cpu_percent "$total_ticks")"
+printf "single session %d KiB\n" "$baseline_pss"
+if ((SESSIONS > 1)); then
+    printf "per additional session %d KiB\n" "$(((total_pss - baseline_pss) / (SESSIONS - 1)))"
+fi
+
+exit "$over_budget"
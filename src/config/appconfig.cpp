@@ -1,3 +1,109 @@
 #include "config/appconfig.h"
+#include "config/configwriter.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSettings>
+
+namespace
+{
+// Programs rewriting the file may do it in several steps
+constexpr int ReloadDelayMs = 200;
+}
 
 AppConfig* appConfig = &AppConfig::instance();
+
+AppConfig::AppConfig(QObject* parent)
+    : QObject(parent), writer(nullptr), watcher(nullptr)
+{
+    reloadTimer.setSingleShot(true);
+    reloadTimer.setInterval(ReloadDelayMs);
+
+    connect(&reloadTimer, &QTimer::timeout, this, &AppConfig::reload);
+}
+
+void AppConfig::load() const
+{
+    QSettings settings;
+    fileName = settings.fileName();
+
+    current.store(ConfigWriter::read(settings), std::memory_order_release);
+}
+
+void AppConfig::watch()
+{
+    snapshot();
+    watchFile();
+}
+
+void AppConfig::reload()
+{
+    snapshot();
+    watchFile();
+    fileWriter().read();
+}
+
+ConfigWriter& AppConfig::fileWriter()
+{
+    // Owned by the application so it is flushed and joined before exit
+    if (!writer) {
+        writer = new ConfigWriter(fileName, qApp);
+        connect(writer, &ConfigWriter::loaded, this, &AppConfig::apply);
+    }
+
+    return *writer;
+}
+
+void AppConfig::scheduleWrite()
+{
+    fileWriter().schedule(current.load(std::memory_order_acquire));
+}
+
+void AppConfig::watchFile()
+{
+    // A file replaced by a rename is dropped by the watcher, so the
+    // directory is watched too and the file added back after each change
+    if (!watcher) {
+        watcher = new QFileSystemWatcher(this);
+        connect(watcher, &QFileSystemWatcher::fileChanged, &reloadTimer, qOverload<>(&QTimer::start));
+        connect(watcher, &QFileSystemWatcher::directoryChanged, &reloadTimer, qOverload<>(&QTimer::start));
+    }
+
+    const QString dir = QFileInfo(fileName).absolutePath();
+
+    if (QFileInfo::exists(dir) && !watcher->directories().contains(dir)) {
+        watcher->addPath(dir);
+    }
+
+    if (QFileInfo::exists(fileName) && !watcher->files().contains(fileName)) {
+        watcher->addPath(fileName);
+    }
+}
+
+void AppConfig::apply(const std::shared_ptr<const ConfigSnapshot>& values, quint64 written)
+{
+    // Local changes not on disk yet win; their write triggers another read
+    if (written < writer->generation()) {
+        return;
+    }
+
+    const auto previous = current.load(std::memory_order_acquire);
+
+    QStringList changedKeys;
+    ConfigSnapshot::forEachKey([&previous, &values, &changedKeys]<class Key>() {
+        if (previous->template get<Key>() != values->template get<Key>()) {
+            changedKeys.append(Key::name());
+        }
+    });
+
+    if (changedKeys.isEmpty()) {
+        return;
+    }
+
+    current.store(values, std::memory_order_release);
+
+    for (const QString& key : std::as_const(changedKeys)) {
+        emit changed(key);
+    }
+}
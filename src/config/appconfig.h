@@ -3,7 +3,17 @@
 #define APPCONFIG_H
 
 #include <QObject>
-#include <QSettings>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
+#include "config/configkeys.h"
 
 template<class T>
 concept ConfigKeyConcept = requires{
@@ -12,6 +22,67 @@ concept ConfigKeyConcept = requires{
     {T::defaultValue()} -> std::convertible_to<typename T::Type>;
 };
 
+template<class List>
+class ConfigValues;
+
+// Typed value of every key in Keys
+template<class... Keys>
+class ConfigValues<ConfigKey::KeyList<Keys...>>
+{
+public:
+    ConfigValues()
+        : values(Keys::defaultValue()...)
+    {}
+
+    template<ConfigKeyConcept Key>
+    const typename Key::Type& get() const
+    {
+        return std::get<indexOf<Key>()>(values);
+    }
+
+    template<ConfigKeyConcept Key>
+    void set(const typename Key::Type& value)
+    {
+        std::get<indexOf<Key>()>(values) = value;
+    }
+
+    // Calls functor.template operator()<Key>() for every key
+    template<class Functor>
+    static void forEachKey(Functor&& functor)
+    {
+        (functor.template operator()<Keys>(), ...);
+    }
+
+private:
+    template<class Key>
+    static constexpr std::size_t indexOf()
+    {
+        static_assert((std::is_same_v<Key, Keys> || ...), "key missing from ConfigKey::AllKeys");
+
+        std::size_t index = 0;
+        static_cast<void>(((std::is_same_v<Key, Keys> ? true : (++index, false)) || ...));
+        return index;
+    }
+
+    std::tuple<typename Keys::Type...> values;
+};
+
+using ConfigSnapshot = ConfigValues<ConfigKey::AllKeys>;
+
+class ConfigWriter;
+class QFileSystemWatcher;
+
+/*
+ * Settings, read from QSettings once and then served from an immutable
+ * snapshot in memory. set() publishes a modified copy of the snapshot, so
+ * a reader on any thread sees either the old or the new values, never a
+ * mix, and never takes a lock. set() and the change signal belong to the
+ * GUI thread; the settings file is written behind it by a ConfigWriter.
+ *
+ * Once watch() was called, a settings file changed by someone else is
+ * parsed again off the GUI thread and the keys that differ are applied
+ * in a single swap, followed by a changed() for each of them.
+ */
 class AppConfig : public QObject
 {
     Q_OBJECT
@@ -22,25 +93,72 @@ public:
         return s_instance;
     }
 
+    // Loads the settings on first use, so after the application names are set
+    std::shared_ptr<const ConfigSnapshot> snapshot() const
+    {
+        std::call_once(loaded, [this]() {
+            load();
+        });
+        return current.load(std::memory_order_acquire);
+    }
+
     template<ConfigKeyConcept Key>
-    typename Key::Type get()
+    typename Key::Type get() const
     {
-        QVariant v = settings.value(Key::name(), QVariant::fromValue(Key::defaultValue()));
-        return v.value<typename Key::Type>();
+        return snapshot()->template get<Key>();
     }
 
     template<ConfigKeyConcept Key>
     void set(const typename Key::Type& value)
     {
-        settings.setValue(Key::name(), QVariant::fromValue(value));
+        const auto previous = snapshot();
+        if (previous->template get<Key>() == value) {
+            return;
+        }
+
+        auto next = std::make_shared<ConfigSnapshot>(*previous);
+        next->template set<Key>(value);
+        current.store(std::move(next), std::memory_order_release);
+
+        scheduleWrite();
+
+        emit changed(Key::name());
+    }
+
+    // Starts following changes made to the settings file by other programs
+    void watch();
+    // Reads the settings file again and applies what changed
+    void reload();
+
+    // Calls functor with the new value whenever Key changes
+    template<ConfigKeyConcept Key, class Functor>
+    QMetaObject::Connection onChanged(const QObject* context, Functor functor)
+    {
+        return connect(this, &AppConfig::changed, context, [this, functor](const QString& name) {
+            if (name == Key::name()) {
+                functor(get<Key>());
+            }
+        });
     }
 
+signals:
+    void changed(const QString& key);
+
 private:
-    explicit AppConfig(QObject* parent = nullptr)
-        : QObject(parent)
-    {}
+    explicit AppConfig(QObject* parent = nullptr);
+
+    void load() const;
+    ConfigWriter& fileWriter();
+    void scheduleWrite();
+    void watchFile();
+    void apply(const std::shared_ptr<const ConfigSnapshot>& values, quint64 written);
 
-    QSettings settings;
+    mutable std::once_flag loaded;
+    mutable std::atomic<std::shared_ptr<const ConfigSnapshot>> current;
+    mutable QString fileName;
+    ConfigWriter* writer;
+    QFileSystemWatcher* watcher;
+    QTimer reloadTimer;
     Q_DISABLE_COPY(AppConfig)
 };
 
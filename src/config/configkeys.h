@@ -1,3 +1,6 @@
+#ifndef CONFIGKEYS_H
+#define CONFIGKEYS_H
+
 #include <QString>
 #include <QStringLiteral>
 #include <QList>
@@ -64,4 +67,37 @@ struct SelectedCharacterSets {
         return {};
     }
 };
+
+struct PopupBackend {
+    using Type = QString;
+    static QString name()
+    {
+        return QStringLiteral("popupBackend");
+    }
+    static Type defaultValue()
+    {
+        return QStringLiteral("widget");
+    }
+};
+
+struct LowFootprint {
+    using Type = bool;
+    static QString name()
+    {
+        return QStringLiteral("lowFootprint");
+    }
+    static Type defaultValue()
+    {
+        return false;
+    }
+};
+
+// Every key; AppConfig keeps a value for each in its snapshot
+template<class... Keys>
+struct KeyList {};
+
+using AllKeys = KeyList<Active, StartHidden, AutoStart, SelectedAllCharacterSets, SelectedCharacterSets,
+                        PopupBackend, LowFootprint>;
 }
+
+#endif // CONFIGKEYS_H
@@ -0,0 +1,157 @@
+#include "config/configwriter.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+// Long enough to collapse the toggles of a dialog into one write
+constexpr int DebounceInterval = 500; // ms
+
+bool syncPath(const QString &path, int flags)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), flags | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+}
+
+ConfigWriter::ConfigWriter(const QString &path, QObject *parent)
+    : QObject(parent), path(path)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(DebounceInterval);
+    connect(&timer, &QTimer::timeout, this, &ConfigWriter::startWrite);
+
+    worker.moveToThread(&thread);
+    thread.setObjectName(QStringLiteral("ConfigWriter"));
+    thread.start(QThread::LowPriority);
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &ConfigWriter::flush);
+}
+
+ConfigWriter::~ConfigWriter()
+{
+    flush();
+    thread.quit();
+    thread.wait();
+}
+
+void ConfigWriter::schedule(const Snapshot &values)
+{
+    pending = values;
+    ++scheduled;
+    timer.start();
+}
+
+void ConfigWriter::flush()
+{
+    timer.stop();
+
+    if (!thread.isRunning()) {
+        if (pending) {
+            write(path, std::exchange(pending, nullptr));
+            written = scheduled;
+        }
+        return;
+    }
+
+    startWrite();
+
+    // Queued behind any write still in progress
+    QMetaObject::invokeMethod(&worker, []() {}, Qt::BlockingQueuedConnection);
+}
+
+void ConfigWriter::startWrite()
+{
+    if (!pending) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(&worker, [this, values = std::exchange(pending, nullptr), generation = scheduled]() {
+        write(path, values);
+        written = generation;
+    }, Qt::QueuedConnection);
+}
+
+void ConfigWriter::read()
+{
+    QMetaObject::invokeMethod(&worker, [this]() {
+        QSettings settings(path, QSettings::IniFormat);
+        const Snapshot values = read(settings);
+
+        QMetaObject::invokeMethod(this, [this, values, generation = written]() {
+            emit loaded(values, generation);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+ConfigWriter::Snapshot ConfigWriter::read(QSettings &settings)
+{
+    auto values = std::make_shared<ConfigSnapshot>();
+    ConfigSnapshot::forEachKey([&settings, &values]<class Key>() {
+        const QVariant value = settings.value(Key::name(), QVariant::fromValue(Key::defaultValue()));
+        values->template set<Key>(value.value<typename Key::Type>());
+    });
+
+    return values;
+}
+
+bool ConfigWriter::write(const QString &path, const Snapshot &values)
+{
+    const QString temporary = path + QStringLiteral(".new");
+    QFile::remove(temporary);
+
+    {
+        QSettings current(path, QSettings::IniFormat);
+        QSettings next(temporary, QSettings::IniFormat);
+
+        // Keys this version does not know about are carried over
+        const QStringList keys = current.allKeys();
+        for (const QString &key : keys) {
+            next.setValue(key, current.value(key));
+        }
+
+        ConfigSnapshot::forEachKey([&next, &values]<class Key>() {
+            next.setValue(Key::name(), QVariant::fromValue(values->template get<Key>()));
+        });
+
+        next.sync();
+        if (next.status() != QSettings::NoError) {
+            qWarning() << "Failed to write settings to" << temporary;
+            QFile::remove(temporary);
+            return false;
+        }
+    }
+
+    if (!syncPath(temporary, O_RDONLY)) {
+        qWarning() << "Failed to sync" << temporary;
+        QFile::remove(temporary);
+        return false;
+    }
+
+    if (std::rename(QFile::encodeName(temporary).constData(), QFile::encodeName(path).constData()) != 0) {
+        qWarning() << "Failed to replace" << path;
+        QFile::remove(temporary);
+        return false;
+    }
+
+    // Makes the rename itself durable
+    syncPath(QFileInfo(path).absolutePath(), O_RDONLY | O_DIRECTORY);
+
+    return true;
+}
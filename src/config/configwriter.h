@@ -0,0 +1,71 @@
+// config/configwriter.h
+#ifndef CONFIGWRITER_H
+#define CONFIGWRITER_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include <memory>
+
+class QSettings;
+
+#include "config/appconfig.h"
+
+/*
+ * Settings file I/O off the GUI thread. Snapshots handed to
+ * schedule() within the debounce interval collapse into one write, done
+ * on a worker thread into a temporary file that is synced and renamed
+ * over the settings file, so a crash leaves either the old or the new
+ * file. Pending changes are flushed when the application quits. read()
+ * parses the file on the same thread, in order with the writes.
+ *
+ * Every scheduled snapshot gets the next generation. A read reports the
+ * generation of the last write that finished before it, so a reader can
+ * tell a file that lacks changes still pending or being written.
+ */
+class ConfigWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Snapshot = std::shared_ptr<const ConfigSnapshot>;
+
+    ConfigWriter(const QString &path, QObject *parent = nullptr);
+    ~ConfigWriter();
+
+    void schedule(const Snapshot &values);
+    // Generation of the last scheduled snapshot, 0 if there was none
+    quint64 generation() const
+    {
+        return scheduled;
+    }
+
+    // Blocks until every scheduled snapshot is on disk
+    void flush();
+
+    // Parses the file on the worker thread and emits loaded()
+    void read();
+    static Snapshot read(QSettings &settings);
+
+signals:
+    // written is the generation of the last write the file contains
+    void loaded(const ConfigWriter::Snapshot &values, quint64 written);
+
+private:
+    void startWrite();
+    static bool write(const QString &path, const Snapshot &values);
+
+    QString path;
+    QTimer timer;
+    QThread thread;
+    // Lives in thread, runs the writes in order
+    QObject worker;
+    Snapshot pending;
+    quint64 scheduled = 0;
+    // Only touched on the worker thread, or once it has stopped
+    quint64 written = 0;
+};
+
+#endif // CONFIGWRITER_H
@@ -1,7 +1,7 @@
 #ifndef ACCENTMAP_H
 #define ACCENTMAP_H
 
-#include <QMap>
+#include <QHash>
 #include <QStringList>
 #include <QChar>
 
@@ -49,8 +49,30 @@ enum class Language {
     SV,      // Swedish
     TK,      // Turkish
     VI,      // Vietnamese
+    UNI,     // Every precomposed letter, from the Unicode decompositions
+    COMPOSE, // X11 Compose tables
+    CUSTOM,  // User defined (customaccents.txt)
 };
 
+inline constexpr int LanguageCount = static_cast<int>(Language::CUSTOM) + 1;
+
+// One bit per Language, used to select the sets a lookup draws from
+using LanguageMask = quint64;
+
+static_assert(LanguageCount <= 64, "LanguageMask has one bit per language");
+
+inline constexpr LanguageMask languageBit(Language lang)
+{
+    return LanguageMask(1) << static_cast<int>(lang);
+}
+
+// Sets that are not languages; they are only used when chosen one by one
+inline constexpr LanguageMask OptionalSetsMask = languageBit(Language::UNI) | languageBit(Language::COMPOSE)
+                                                 | languageBit(Language::CUSTOM);
+
+// What "All Languages" selects
+inline constexpr LanguageMask AllLanguagesMask = ((LanguageMask(1) << LanguageCount) - 1) & ~OptionalSetsMask;
+
 struct LanguageInfo {
     Language language;
     QString code;
@@ -60,59 +82,32 @@ struct LanguageInfo {
 class AccentMap
 {
 public:
-    static QStringList getAccents(QChar baseChar, const QStringList &langCodes);
+    static QStringList getAccents(char32_t baseChar, const QStringList &langCodes);
+    static QStringList getAccents(char32_t baseChar, LanguageMask languages);
+    static LanguageMask languageMask(const QStringList &langCodes);
+    // Sets for the settings: every language or those in langCodes, plus
+    // the optional sets in langCodes
+    static LanguageMask selectionMask(bool allLanguages, const QStringList &langCodes);
+    static bool isOptional(Language lang)
+    {
+        return languageBit(lang) & OptionalSetsMask;
+    }
+    // Sets selected in the settings, computed once per change
+    static LanguageMask selectedLanguages();
     static QList<LanguageInfo> getAllLanguages();
+    static void clearCache();
 
-private:
-    static QStringList getAccentsForLanguage(QChar baseChar, Language lang);
-    static QStringList getAccentsForLanguage(QChar baseChar, const QString &langCode);
+    // Estimated heap held by the result cache
+    static qint64 cacheMemoryUsage();
+    // Size of the built-in tables, read-only data shared by every process
+    static qint64 tableSize();
 
-    // Individual language accent maps
-    static QStringList getAccentsBG(QChar c);
-    static QStringList getAccentsCA(QChar c);
-    static QStringList getAccentsCRH(QChar c);
-    static QStringList getAccentsCUR(QChar c);
-    static QStringList getAccentsCY(QChar c);
-    static QStringList getAccentsCZ(QChar c);
-    static QStringList getAccentsDK(QChar c);
-    static QStringList getAccentsGA(QChar c);
-    static QStringList getAccentsGD(QChar c);
-    static QStringList getAccentsDE(QChar c);
-    static QStringList getAccentsEL(QChar c);
-    static QStringList getAccentsEST(QChar c);
-    static QStringList getAccentsEPO(QChar c);
-    static QStringList getAccentsFI(QChar c);
-    static QStringList getAccentsFR(QChar c);
-    static QStringList getAccentsHR(QChar c);
-    static QStringList getAccentsHE(QChar c);
-    static QStringList getAccentsHU(QChar c);
-    static QStringList getAccentsIS(QChar c);
-    static QStringList getAccentsIPA(QChar c);
-    static QStringList getAccentsIT(QChar c);
-    static QStringList getAccentsKU(QChar c);
-    static QStringList getAccentsLT(QChar c);
-    static QStringList getAccentsMK(QChar c);
-    static QStringList getAccentsMT(QChar c);
-    static QStringList getAccentsMI(QChar c);
-    static QStringList getAccentsNL(QChar c);
-    static QStringList getAccentsNO(QChar c);
-    static QStringList getAccentsPI(QChar c);
-    static QStringList getAccentsPIE(QChar c);
-    static QStringList getAccentsPL(QChar c);
-    static QStringList getAccentsPT(QChar c);
-    static QStringList getAccentsRO(QChar c);
-    static QStringList getAccentsROM(QChar c);
-    static QStringList getAccentsSK(QChar c);
-    static QStringList getAccentsSL(QChar c);
-    static QStringList getAccentsSP(QChar c);
-    static QStringList getAccentsSR(QChar c);
-    static QStringList getAccentsSRCyrillic(QChar c);
-    static QStringList getAccentsSV(QChar c);
-    static QStringList getAccentsTK(QChar c);
-    static QStringList getAccentsVI(QChar c);
-
-    // Cache for ALL languages
-    static QMap<QChar, QStringList> allLanguagesCache;
+private:
+    // Results for the most recently used language mask
+    static QHash<char32_t, QStringList> resultCache;
+    static LanguageMask resultCacheMask;
+    static LanguageMask selectedMask;
+    static bool selectedMaskValid;
 };
 
 #endif // ACCENTMAP_H
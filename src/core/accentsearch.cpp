@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/accentsearch.h"
+
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <string_view>
+
+#include "accentnames.h"
+
+namespace
+{
+using AccentNames::Name;
+using AccentNames::NameCount;
+
+// Text from offset up to the end of the pool
+std::string_view suffixAt(quint32 offset)
+{
+    return std::string_view(AccentNames::namePool + offset, sizeof(AccentNames::namePool) - 1 - offset);
+}
+
+std::string_view nameAt(int index)
+{
+    const Name &name = AccentNames::names[index];
+    return std::string_view(AccentNames::namePool + name.offset, name.length);
+}
+
+// Index of the name that contains offset
+int ownerOf(quint32 offset)
+{
+    const Name *end = AccentNames::names + NameCount;
+    const Name *it = std::upper_bound(AccentNames::names, end, offset, [](quint32 value, const Name &name) {
+        return value < name.offset;
+    });
+    return static_cast<int>(it - AccentNames::names) - 1;
+}
+
+bool hasWordPrefix(std::string_view name, std::string_view word)
+{
+    for (size_t i = 0; i < name.size(); ++i) {
+        if ((i == 0 || name[i - 1] == ' ' || name[i - 1] == '-') && name.substr(i).starts_with(word)) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+QStringList AccentSearch::search(QStringView query, int limit)
+{
+    // Names are ASCII; anything else cannot match
+    const QByteArray text = query.toString().toLower().toLatin1();
+
+    QVarLengthArray<std::string_view, 8> words;
+    for (qsizetype start = 0; start < text.size();) {
+        qsizetype end = text.indexOf(' ', start);
+        if (end < 0) {
+            end = text.size();
+        }
+        if (end > start) {
+            words.append(std::string_view(text.constData() + start, static_cast<size_t>(end - start)));
+        }
+        start = end + 1;
+    }
+
+    if (words.isEmpty()) {
+        return QStringList();
+    }
+
+    // The longest word narrows the suffix range the most
+    const std::string_view key = *std::max_element(words.cbegin(), words.cend(), [](std::string_view a, std::string_view b) {
+        return a.size() < b.size();
+    });
+
+    const auto prefixOf = [&key](quint32 offset) {
+        return suffixAt(offset).substr(0, key.size());
+    };
+
+    const quint32 *begin = std::begin(AccentNames::wordSuffixes);
+    const quint32 *end = std::end(AccentNames::wordSuffixes);
+    const quint32 *lower = std::lower_bound(begin, end, key, [&prefixOf](quint32 offset, std::string_view value) {
+        return prefixOf(offset) < value;
+    });
+    const quint32 *upper = std::upper_bound(lower, end, key, [&prefixOf](std::string_view value, quint32 offset) {
+        return value < prefixOf(offset);
+    });
+
+    QVarLengthArray<int, 256> matches;
+    for (const quint32 *it = lower; it != upper; ++it) {
+        matches.append(ownerOf(*it));
+    }
+
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+    // Every other word has to start a word of the same name
+    const auto rejected = std::remove_if(matches.begin(), matches.end(), [&words, &key](int index) {
+        const std::string_view name = nameAt(index);
+        return std::any_of(words.cbegin(), words.cend(), [&name, &key](std::string_view word) {
+            return word.data() != key.data() && !hasWordPrefix(name, word);
+        });
+    });
+    matches.erase(rejected, matches.end());
+
+    // Shorter names are closer to what was typed; code point order otherwise
+    std::stable_sort(matches.begin(), matches.end(), [](int a, int b) {
+        return AccentNames::names[a].length < AccentNames::names[b].length;
+    });
+
+    QStringList result;
+    const qsizetype count = qMin<qsizetype>(matches.size(), limit);
+    result.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        const char32_t codePoint = AccentNames::names[matches[i]].codePoint;
+        result.append(QString::fromUcs4(&codePoint, 1));
+    }
+
+    return result;
+}
+
+qint64 AccentSearch::indexSize()
+{
+    return static_cast<qint64>(sizeof(AccentNames::namePool) + sizeof(AccentNames::names)
+                               + sizeof(AccentNames::wordSuffixes));
+}
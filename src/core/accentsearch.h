@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ACCENTSEARCH_H
+#define ACCENTSEARCH_H
+
+#include <QStringList>
+#include <QStringView>
+
+/*
+ * Search by Unicode name over every single character candidate. The index
+ * is generated into accentnames.h by tools/accentgen: the names in one
+ * pool and a suffix array over the start of each word. It is read-only
+ * data of the binary, paged in on first use and never copied or parsed.
+ */
+class AccentSearch
+{
+public:
+    // Characters whose name has a word starting with each word of query,
+    // shortest name first
+    static QStringList search(QStringView query, int limit = 64);
+
+    // Size of the index in the read-only data of the binary
+    static qint64 indexSize();
+};
+
+#endif // ACCENTSEARCH_H
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/accenttablecache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+
+#include <vector>
+
+namespace
+{
+constexpr quint32 CacheVersion = 2;
+// First character of the pool, tells a cache written with another byte order
+constexpr char16_t PoolMark = 0xFEFF;
+
+struct PooledString {
+    quint32 offset;
+    quint32 length;
+};
+}
+
+AccentTableCache::AccentTableCache(const QString &path, quint32 magic)
+    : path(path), magic(magic)
+{
+}
+
+QList<AccentTableCache::Source> AccentTableCache::sources() const
+{
+    Header header;
+    return read(header, nullptr) ? header.sources : QList<Source>();
+}
+
+bool AccentTableCache::loadIfFresh(Table &table) const
+{
+    Header header;
+    if (!read(header, nullptr) || header.sources.isEmpty()) {
+        return false;
+    }
+
+    for (const Source &source : std::as_const(header.sources)) {
+        if (stat(source.path) != source) {
+            return false;
+        }
+    }
+
+    return read(header, &table);
+}
+
+bool AccentTableCache::loadIfHash(const QByteArray &hash, Table &table) const
+{
+    Header header;
+    if (!read(header, nullptr) || header.hash != hash) {
+        return false;
+    }
+
+    return read(header, &table);
+}
+
+void AccentTableCache::save(const QList<Source> &sources, const QByteArray &hash, const Table &table) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << magic << CacheVersion;
+
+    stream << static_cast<quint32>(sources.size());
+    for (const Source &source : sources) {
+        stream << source.path << source.mtime << source.size;
+    }
+    stream << hash;
+
+    QString pool(1, QChar(PoolMark));
+
+    stream << static_cast<quint32>(table.size());
+    for (qsizetype i = 0; i < table.size(); ++i) {
+        const QStringList &accents = table.values()[i];
+        stream << static_cast<quint32>(table.keys()[i]) << static_cast<quint32>(accents.size());
+
+        for (const QString &accent : accents) {
+            stream << static_cast<quint32>(pool.size()) << static_cast<quint32>(accent.size());
+            pool += accent;
+        }
+    }
+
+    // The pool is written in host byte order at an even offset so that it
+    // can be used in place
+    stream << static_cast<quint32>(pool.size());
+    if (file.pos() % 2) {
+        stream << quint8(0);
+    }
+    stream.writeRawData(reinterpret_cast<const char*>(pool.constData()), pool.size() * 2);
+
+    file.commit();
+}
+
+AccentTableCache::Source AccentTableCache::stat(const QString &path)
+{
+    const QFileInfo info(path);
+
+    Source source;
+    source.path = path;
+    if (info.exists()) {
+        source.mtime = info.lastModified().toMSecsSinceEpoch();
+        source.size = info.size();
+    }
+
+    return source;
+}
+
+QStringList AccentTableCache::lookup(const Table &table, char32_t baseChar)
+{
+    if (const QStringList *accents = table.find(baseChar)) {
+        return *accents;
+    }
+
+    const QStringList *accents = table.find(QChar::toLower(baseChar));
+    if (!accents || !QChar::isUpper(baseChar)) {
+        return accents ? *accents : QStringList();
+    }
+
+    const QLocale locale = QLocale::system();
+    QStringList upper;
+    for (const QString &accent : *accents) {
+        upper.append(locale.toUpper(accent));
+    }
+
+    return upper;
+}
+
+QString AccentTableCache::owned(const QString &accent)
+{
+    return accent.capacity() > 0 ? accent : QString(accent.constData(), accent.size());
+}
+
+qint64 AccentTableCache::memoryUsage(const Table &table)
+{
+    qint64 bytes = static_cast<qint64>(table.indexBytes());
+
+    for (const QStringList &accents : table.values()) {
+        bytes += accents.capacity() * static_cast<qint64>(sizeof(QString));
+        for (const QString &accent : accents) {
+            // Strings pointing into a mapped cache own no memory
+            if (accent.capacity() > 0) {
+                // Payload plus the allocation header of each string
+                bytes += (accent.capacity() + 1) * static_cast<qint64>(sizeof(QChar)) + 16;
+            }
+        }
+    }
+
+    return bytes;
+}
+
+QByteArray AccentTableCache::hashFiles(const QList<Source> &sources)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    for (const Source &source : sources) {
+        QFile file(source.path);
+        if (file.open(QIODevice::ReadOnly)) {
+            hash.addData(&file);
+        }
+        // Separates the files so moving bytes across them changes the hash
+        hash.addData(QByteArrayView("\0", 1));
+    }
+
+    return hash.result();
+}
+
+bool AccentTableCache::read(Header &header, Table *table) const
+{
+    auto file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(file.get());
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 fileMagic = 0;
+    quint32 version = 0;
+
+    stream >> fileMagic >> version;
+    if (fileMagic != magic || version != CacheVersion) {
+        return false;
+    }
+
+    quint32 sourceCount = 0;
+    stream >> sourceCount;
+
+    header.sources.clear();
+    for (quint32 i = 0; i < sourceCount && stream.status() == QDataStream::Ok; ++i) {
+        Source source;
+        stream >> source.path >> source.mtime >> source.size;
+        header.sources.append(source);
+    }
+    stream >> header.hash;
+
+    if (!table || stream.status() != QDataStream::Ok) {
+        return stream.status() == QDataStream::Ok;
+    }
+
+    quint32 count = 0;
+    stream >> count;
+
+    // Read in full before the table is touched; the pool comes last
+    std::vector<std::pair<quint32, std::vector<PooledString>>> entries;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint32 codePoint = 0;
+        quint32 accentCount = 0;
+        stream >> codePoint >> accentCount;
+
+        if (codePoint > Table::MaxCodePoint || accentCount > file->size() / 8) {
+            return false;
+        }
+
+        std::vector<PooledString> accents(accentCount);
+        for (PooledString &accent : accents) {
+            stream >> accent.offset >> accent.length;
+        }
+        entries.emplace_back(codePoint, std::move(accents));
+    }
+
+    quint32 poolSize = 0;
+    stream >> poolSize;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    const qint64 poolStart = file->pos() + file->pos() % 2;
+    if (poolSize == 0 || poolStart + qint64(poolSize) * 2 != file->size()) {
+        return false;
+    }
+
+    const uchar *mapped = file->map(poolStart, qint64(poolSize) * 2);
+    if (!mapped) {
+        return false;
+    }
+
+    const auto *pool = reinterpret_cast<const QChar*>(mapped);
+    if (pool[0] != QChar(PoolMark)) {
+        file->unmap(const_cast<uchar*>(mapped));
+        return false;
+    }
+
+    for (const auto &[codePoint, accents] : entries) {
+        for (const PooledString &accent : accents) {
+            if (accent.offset > poolSize || accent.length > poolSize - accent.offset) {
+                file->unmap(const_cast<uchar*>(mapped));
+                return false;
+            }
+        }
+    }
+
+    table->clear();
+    for (const auto &[codePoint, accents] : entries) {
+        QStringList &list = (*table)[codePoint];
+        list.reserve(accents.size());
+        for (const PooledString &accent : accents) {
+            list.append(QString::fromRawData(pool + accent.offset, accent.length));
+        }
+    }
+
+    table->mapping = std::move(file);
+
+    return true;
+}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ACCENTTABLECACHE_H
+#define ACCENTTABLECACHE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+#include "core/codepointtable.h"
+
+/*
+ * Binary cache of a base -> candidates table compiled from one or more
+ * text sources. The cache records the modification time and size of
+ * every source plus a hash of their content, so a caller can skip
+ * reading the sources when nothing was touched and skip parsing them
+ * when only the timestamps changed.
+ *
+ * The candidates are stored as one UTF-16 pool that a load maps read-only
+ * and points into instead of copying, so every session of the user shares
+ * the same pages. The mapping belongs to the loaded table and goes away
+ * with its last copy. lookup() hands out strings that point into it, so
+ * a caller that keeps one past the table takes an owned() copy.
+ */
+class AccentTableCache
+{
+public:
+    struct Table : CodePointTable<QStringList> {
+        // Cache file the strings point into, null for a parsed table
+        std::shared_ptr<QFile> mapping;
+    };
+
+    struct Source {
+        QString path;
+        qint64 mtime = 0;
+        qint64 size = -1; // -1 when the file does not exist
+
+        bool operator==(const Source &other) const = default;
+    };
+
+    AccentTableCache(const QString &path, quint32 magic);
+
+    // Sources recorded by the last save(), empty if there is no valid cache
+    QList<Source> sources() const;
+
+    // Loads the table if every recorded source is unchanged on disk
+    bool loadIfFresh(Table &table) const;
+
+    // Loads the table if it was compiled from content with this hash
+    bool loadIfHash(const QByteArray &hash, Table &table) const;
+
+    void save(const QList<Source> &sources, const QByteArray &hash, const Table &table) const;
+
+    static Source stat(const QString &path);
+
+    // Candidates for baseChar; an upper case base falls back to the lower
+    // case entry with its candidates converted to upper case. The strings
+    // may point into table and are only valid as long as it is.
+    static QStringList lookup(const Table &table, char32_t baseChar);
+
+    // Copy of a string from lookup() that owns its data
+    static QString owned(const QString &accent);
+
+    // Estimated heap held by table and its strings
+    static qint64 memoryUsage(const Table &table);
+
+    // SHA-1 over the content of the given files, in order
+    static QByteArray hashFiles(const QList<Source> &sources);
+
+private:
+    struct Header {
+        QList<Source> sources;
+        QByteArray hash;
+    };
+
+    bool read(Header &header, Table *table) const;
+
+    QString path;
+    quint32 magic;
+};
+
+#endif // ACCENTTABLECACHE_H
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CODEPOINTTABLE_H
+#define CODEPOINTTABLE_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+/*
+ * Sparse map from Unicode code point to T, laid out as a two-stage
+ * table like the Unicode property tables: the high bits of the code
+ * point select a page, the low bits a slot inside it. Pages without
+ * entries all share page 0, so lookups are two array reads over the
+ * whole code space and the table stays a few kilobytes.
+ */
+template<typename T>
+class CodePointTable
+{
+public:
+    static constexpr char32_t MaxCodePoint = 0x10FFFF;
+    static constexpr int PageBits = 8;
+    static constexpr int PageSize = 1 << PageBits;
+    static constexpr int PageCount = (MaxCodePoint + 1) >> PageBits;
+
+    CodePointTable()
+        : stage1(PageCount, 0), stage2(PageSize, 0)
+    {}
+
+    const T* find(char32_t codePoint) const
+    {
+        if (codePoint > MaxCodePoint) {
+            return nullptr;
+        }
+
+        const quint16 slot = stage2[slotIndex(codePoint)];
+        return slot ? &entries[slot - 1] : nullptr;
+    }
+
+    bool contains(char32_t codePoint) const
+    {
+        return find(codePoint) != nullptr;
+    }
+
+    // Returns the entry for codePoint, default constructing it if needed
+    T& operator[](char32_t codePoint)
+    {
+        Q_ASSERT(codePoint <= MaxCodePoint);
+
+        quint16 &page = stage1[codePoint >> PageBits];
+        if (page == 0) {
+            page = static_cast<quint16>(stage2.size() / PageSize);
+            stage2.resize(stage2.size() + PageSize, 0);
+        }
+
+        quint16 &slot = stage2[slotIndex(codePoint)];
+        if (slot == 0) {
+            entries.emplace_back();
+            codePoints.push_back(codePoint);
+            slot = static_cast<quint16>(entries.size());
+        }
+
+        return entries[slot - 1];
+    }
+
+    // Code points in insertion order, parallel to values()
+    const std::vector<char32_t>& keys() const
+    {
+        return codePoints;
+    }
+
+    const std::vector<T>& values() const
+    {
+        return entries;
+    }
+
+    qsizetype size() const
+    {
+        return static_cast<qsizetype>(entries.size());
+    }
+
+    bool isEmpty() const
+    {
+        return entries.empty();
+    }
+
+    // Heap used by the table itself, not counting what the values own
+    size_t indexBytes() const
+    {
+        return (stage1.capacity() + stage2.capacity()) * sizeof(quint16)
+               + entries.capacity() * sizeof(T) + codePoints.capacity() * sizeof(char32_t);
+    }
+
+    void clear()
+    {
+        *this = CodePointTable();
+    }
+
+private:
+    size_t slotIndex(char32_t codePoint) const
+    {
+        return (static_cast<size_t>(stage1[codePoint >> PageBits]) << PageBits)
+               | (codePoint & (PageSize - 1));
+    }
+
+    std::vector<quint16> stage1;
+    std::vector<quint16> stage2;
+    std::vector<T> entries;
+    std::vector<char32_t> codePoints;
+};
+
+#endif // CODEPOINTTABLE_H
@@ -0,0 +1,404 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/composeaccents.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <string_view>
+
+namespace
+{
+constexpr quint32 CacheMagic = 0x41504358; // "APCX"
+constexpr int MaxIncludeDepth = 8;
+constexpr auto SystemLocaleDir = "/usr/share/X11/locale";
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool isAlnum(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Code point of a keysym name that can act as a base letter, or 0
+char32_t baseCodePoint(std::string_view name)
+{
+    if (name.size() == 1 && isAlnum(name[0])) {
+        return static_cast<char32_t>(name[0]);
+    }
+
+    if (name.size() < 5 || name.size() > 7 || name[0] != 'U') {
+        return 0;
+    }
+
+    char32_t codePoint = 0;
+    for (char c : name.substr(1)) {
+        const int value = hexValue(c);
+        if (value < 0) {
+            return 0;
+        }
+        codePoint = (codePoint << 4) | static_cast<char32_t>(value);
+    }
+
+    if (codePoint > AccentTableCache::Table::MaxCodePoint || !QChar::isLetterOrNumber(codePoint)) {
+        return 0;
+    }
+
+    return codePoint;
+}
+
+// Returns the locale's Compose file as listed in compose.dir
+QString localeComposeFile()
+{
+    QString locale = QString::fromLocal8Bit(qgetenv("LC_ALL"));
+    if (locale.isEmpty()) locale = QString::fromLocal8Bit(qgetenv("LC_CTYPE"));
+    if (locale.isEmpty()) locale = QString::fromLocal8Bit(qgetenv("LANG"));
+    if (locale.isEmpty()) locale = QLocale::system().name() + QStringLiteral(".UTF-8");
+
+    QFile dirFile(QString::fromLatin1(SystemLocaleDir) + QStringLiteral("/compose.dir"));
+    if (dirFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!dirFile.atEnd()) {
+            const QByteArray line = dirFile.readLine().simplified();
+            if (line.isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+
+            const QList<QByteArray> fields = line.split(' ');
+            if (fields.size() >= 2 && QString::fromLatin1(fields[1]).compare(locale, Qt::CaseInsensitive) == 0) {
+                QString file = QString::fromLatin1(fields[0]);
+                if (file.endsWith(u':')) {
+                    file.chop(1);
+                }
+                return QString::fromLatin1(SystemLocaleDir) + u'/' + file;
+            }
+        }
+    }
+
+    return QString::fromLatin1(SystemLocaleDir) + QStringLiteral("/en_US.UTF-8/Compose");
+}
+
+/*
+ * Scans Compose files straight from a read-only mapping. Lines are only
+ * looked at through string_views; strings are allocated for the lines
+ * that actually produce a candidate.
+ */
+class ComposeParser
+{
+public:
+    ComposeParser(AccentTableCache::Table &table, QList<AccentTableCache::Source> &visited)
+        : table(table), visited(visited)
+    {}
+
+    void parseFile(const QString &path, int depth = 0)
+    {
+        for (const auto &source : std::as_const(visited)) {
+            if (source.path == path) {
+                return;
+            }
+        }
+
+        visited.append(AccentTableCache::stat(path));
+
+        QFile file(path);
+        if (depth > MaxIncludeDepth || !file.open(QIODevice::ReadOnly) || file.size() == 0) {
+            return;
+        }
+
+        const uchar *data = file.map(0, file.size());
+        if (!data) {
+            return;
+        }
+
+        std::string_view content(reinterpret_cast<const char*>(data), static_cast<size_t>(file.size()));
+
+        while (!content.empty()) {
+            const size_t end = content.find('\n');
+            parseLine(content.substr(0, end), depth);
+            content.remove_prefix(end == std::string_view::npos ? content.size() : end + 1);
+        }
+
+        file.unmap(const_cast<uchar*>(data));
+    }
+
+private:
+    static void skipSpace(std::string_view &line)
+    {
+        while (!line.empty() && isSpace(line.front())) {
+            line.remove_prefix(1);
+        }
+    }
+
+    // Reads a double quoted string with Compose escapes into out
+    static bool readString(std::string_view &line, QVarLengthArray<char, 64> &out)
+    {
+        if (line.empty() || line.front() != '"') {
+            return false;
+        }
+        line.remove_prefix(1);
+
+        while (!line.empty()) {
+            char c = line.front();
+            line.remove_prefix(1);
+
+            if (c == '"') {
+                return true;
+            }
+
+            if (c == '\\' && !line.empty()) {
+                c = line.front();
+                line.remove_prefix(1);
+
+                if (c == 'x' || c == 'X') {
+                    int value = 0;
+                    for (int i = 0; i < 2 && !line.empty() && hexValue(line.front()) >= 0; ++i) {
+                        value = value * 16 + hexValue(line.front());
+                        line.remove_prefix(1);
+                    }
+                    c = static_cast<char>(value);
+                } else if (c >= '0' && c <= '7') {
+                    int value = c - '0';
+                    for (int i = 0; i < 2 && !line.empty() && line.front() >= '0' && line.front() <= '7'; ++i) {
+                        value = value * 8 + (line.front() - '0');
+                        line.remove_prefix(1);
+                    }
+                    c = static_cast<char>(value);
+                }
+            }
+
+            out.append(c);
+        }
+
+        return false;
+    }
+
+    void parseInclude(std::string_view line, int depth)
+    {
+        skipSpace(line);
+
+        QVarLengthArray<char, 64> raw;
+        if (!readString(line, raw)) {
+            return;
+        }
+
+        const QString pattern = QString::fromLocal8Bit(raw.constData(), raw.size());
+        QString path;
+
+        for (qsizetype i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != u'%' || i + 1 == pattern.size()) {
+                path.append(pattern[i]);
+                continue;
+            }
+
+            const QChar spec = pattern[++i];
+            if (spec == u'H') {
+                path.append(QDir::homePath());
+            } else if (spec == u'L') {
+                path.append(localeComposeFile());
+            } else if (spec == u'S') {
+                path.append(QString::fromLatin1(SystemLocaleDir));
+            } else {
+                path.append(spec);
+            }
+        }
+
+        parseFile(path, depth + 1);
+    }
+
+    void parseLine(std::string_view line, int depth)
+    {
+        skipSpace(line);
+
+        if (line.empty() || line.front() == '#') {
+            return;
+        }
+
+        constexpr std::string_view include = "include";
+        if (line.substr(0, include.size()) == include) {
+            parseInclude(line.substr(include.size()), depth);
+            return;
+        }
+
+        // Only sequences of up to three keys are of interest
+        std::string_view keys[3];
+        int keyCount = 0;
+
+        while (!line.empty() && line.front() == '<') {
+            const size_t close = line.find('>');
+            if (close == std::string_view::npos || keyCount == 3) {
+                return;
+            }
+
+            keys[keyCount++] = line.substr(1, close - 1);
+            line.remove_prefix(close + 1);
+            skipSpace(line);
+        }
+
+        const char32_t base = sequenceBase(keys, keyCount);
+        if (base == 0 || line.empty() || line.front() != ':') {
+            return;
+        }
+
+        line.remove_prefix(1);
+        skipSpace(line);
+
+        QVarLengthArray<char, 64> raw;
+        if (!readString(line, raw) || raw.isEmpty()) {
+            return;
+        }
+
+        const QString candidate = QString::fromUtf8(raw.constData(), raw.size());
+        if (candidate == QString::fromUcs4(&base, 1)) {
+            return;
+        }
+
+        QStringList &candidates = table[base];
+        if (!candidates.contains(candidate)) {
+            candidates.append(candidate);
+        }
+    }
+
+    // Base letter of <dead_*> <base> and <Multi_key> <mark> <base> (in
+    // either order) sequences, or 0 for anything else
+    static char32_t sequenceBase(const std::string_view *keys, int keyCount)
+    {
+        char32_t base = 0;
+
+        if (keyCount == 2 && keys[0].substr(0, 5) == "dead_") {
+            base = baseCodePoint(keys[1]);
+        } else if (keyCount == 3 && keys[0] == "Multi_key") {
+            const char32_t first = baseCodePoint(keys[1]);
+            const char32_t second = baseCodePoint(keys[2]);
+
+            // Two letters (e.g. <a> <e> : "æ") are ligatures, not accents
+            if ((first == 0) != (second == 0)) {
+                base = first ? first : second;
+            }
+        }
+
+        // The picker derives upper case candidates from the lower case base
+        if (base != 0 && QChar::toLower(base) != base) {
+            return 0;
+        }
+
+        return base;
+    }
+
+    AccentTableCache::Table &table;
+    QList<AccentTableCache::Source> &visited;
+};
+}
+
+ComposeAccents* composeAccents = &ComposeAccents::instance();
+
+ComposeAccents::ComposeAccents()
+    : table(std::make_shared<const Table>())
+{
+}
+
+QStringList ComposeAccents::getAccents(char32_t baseChar) const
+{
+    const auto current = table.load();
+
+    return AccentTableCache::lookup(*current, baseChar);
+}
+
+qint64 ComposeAccents::memoryUsage() const
+{
+    return AccentTableCache::memoryUsage(*table.load());
+}
+
+void ComposeAccents::load()
+{
+    table.store(readTable());
+}
+
+QStringList ComposeAccents::sourceFiles() const
+{
+    QStringList files;
+
+    // The user's table comes first so its candidates are listed first
+    const QByteArray userFile = qgetenv("XCOMPOSEFILE");
+    files.append(userFile.isEmpty() ? QDir::homePath() + QStringLiteral("/.XCompose")
+                 : QString::fromLocal8Bit(userFile));
+
+    const QDir localeDir(QString::fromLatin1(SystemLocaleDir));
+    const QStringList locales = localeDir.entryList({QStringLiteral("*.UTF-8")}, QDir::Dirs, QDir::Name);
+    for (const QString &locale : locales) {
+        files.append(localeDir.filePath(locale + QStringLiteral("/Compose")));
+    }
+
+    return files;
+}
+
+QString ComposeAccents::cachePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + QStringLiteral("/compose.cache");
+}
+
+void ComposeAccents::parse(const QStringList &files, Table &table,
+                           QList<AccentTableCache::Source> &visited)
+{
+    ComposeParser parser(table, visited);
+
+    for (const QString &file : files) {
+        parser.parseFile(file);
+    }
+}
+
+std::shared_ptr<const ComposeAccents::Table> ComposeAccents::readTable() const
+{
+    const AccentTableCache cache(cachePath(), CacheMagic);
+    const QStringList roots = sourceFiles();
+    const QList<AccentTableCache::Source> recorded = cache.sources();
+
+    auto result = std::make_shared<Table>();
+
+    // A new Compose file (e.g. a freshly created ~/.XCompose) means a re-parse
+    const bool sameRoots = std::all_of(roots.begin(), roots.end(), [&recorded](const QString &root) {
+        return std::any_of(recorded.begin(), recorded.end(), [&root](const AccentTableCache::Source &source) {
+            return source.path == root;
+        });
+    });
+
+    if (sameRoots) {
+        // Fast path: none of the files was touched
+        if (cache.loadIfFresh(*result)) {
+            return result;
+        }
+
+        // Touched, but possibly with the same content
+        const QByteArray hash = AccentTableCache::hashFiles(recorded);
+        if (cache.loadIfHash(hash, *result)) {
+            QList<AccentTableCache::Source> current;
+            for (const auto &source : recorded) {
+                current.append(AccentTableCache::stat(source.path));
+            }
+            cache.save(current, hash, *result);
+            return result;
+        }
+    }
+
+    QList<AccentTableCache::Source> visited;
+    parse(roots, *result, visited);
+
+    cache.save(visited, AccentTableCache::hashFiles(visited), *result);
+
+    return result;
+}
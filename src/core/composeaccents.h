@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COMPOSEACCENTS_H
+#define COMPOSEACCENTS_H
+
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+
+#include "core/accenttablecache.h"
+
+/*
+ * Accent set imported from the X11 Compose tables: the UTF-8 locale
+ * tables under /usr/share/X11/locale and the user's $XCOMPOSEFILE or
+ * ~/.XCompose. Short sequences that combine one base letter with a dead
+ * key or a Multi_key prefix, e.g.
+ *
+ *   <dead_acute> <e>                : "é"
+ *   <Multi_key> <apostrophe> <e>    : "é"
+ *
+ * become base -> candidates entries. The result is cached keyed by the
+ * sources' timestamps and content hash, so the tables are only parsed
+ * again when one of them changed.
+ */
+class ComposeAccents
+{
+public:
+    using Table = AccentTableCache::Table;
+
+    static ComposeAccents& instance()
+    {
+        static ComposeAccents s_instance;
+        return s_instance;
+    }
+
+    // The strings point into the loaded table and stay valid until the
+    // next load; see AccentTableCache::owned()
+    QStringList getAccents(char32_t baseChar) const;
+    qint64 memoryUsage() const;
+
+    void load();
+
+    QStringList sourceFiles() const;
+    QString cachePath() const;
+
+    static void parse(const QStringList &files, Table &table,
+                      QList<AccentTableCache::Source> &visited);
+
+private:
+    ComposeAccents();
+
+    std::shared_ptr<const Table> readTable() const;
+
+    std::atomic<std::shared_ptr<const Table>> table;
+
+    Q_DISABLE_COPY(ComposeAccents)
+};
+
+extern ComposeAccents* composeAccents;
+
+#endif // COMPOSEACCENTS_H
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/controlclient.h"
+#include "core/singleinstance.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+constexpr int UsageError = 2;
+constexpr int NotRunning = 3;
+
+void printUsage()
+{
+    std::fputs("usage: accentpicker --ctl [--bench <count>] <command> [<argument>...]\n"
+               "commands: ping, show, toggle, pause, resume, reload, stats,\n"
+               "          trigger <character>, insert <text>, set-sets all|<code>...\n", stderr);
+}
+}
+
+int ControlClient::run(const QString &key, const QStringList &arguments)
+{
+    QStringList words = arguments;
+    int count = 0;
+
+    if (words.value(0) == QLatin1String("--bench")) {
+        bool valid = false;
+        count = words.value(1).toInt(&valid);
+        if (!valid || count <= 0) {
+            printUsage();
+            return UsageError;
+        }
+        words = words.mid(2);
+    }
+
+    if (words.isEmpty()) {
+        printUsage();
+        return UsageError;
+    }
+
+    const QByteArray command = words.join(u' ').toUtf8();
+
+    if (count > 0) {
+        return bench(key, command, count);
+    }
+
+    const auto replies = SingleInstance::send(key, {command});
+    if (!replies) {
+        std::fputs("accentpicker is not running\n", stderr);
+        return NotRunning;
+    }
+
+    const QByteArray &reply = replies->first();
+    if (reply.startsWith("ok")) {
+        const QByteArray details = reply.mid(3);
+        if (!details.isEmpty()) {
+            std::printf("%s\n", details.constData());
+        }
+        return 0;
+    }
+
+    std::fprintf(stderr, "%s\n", reply.constData());
+    return 1;
+}
+
+int ControlClient::bench(const QString &key, const QByteArray &command, int count)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each round trip connects anew, like one invocation per hotkey does
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(count));
+
+    for (int i = 0; i < count; ++i) {
+        const auto start = Clock::now();
+        const auto replies = SingleInstance::send(key, {command});
+        const auto end = Clock::now();
+
+        if (!replies) {
+            std::fputs("accentpicker is not running\n", stderr);
+            return NotRunning;
+        }
+        if (!replies->first().startsWith("ok")) {
+            std::fprintf(stderr, "%s\n", replies->first().constData());
+            return 1;
+        }
+
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+    };
+
+    std::printf("%d round trips of \"%s\": min %.1f us, median %.1f us, p99 %.1f us, max %.1f us\n",
+                count, command.constData(), samples.front(), percentile(0.5), percentile(0.99), samples.back());
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * `accentpicker --ctl` client of the instance socket. It runs before any
+ * QCoreApplication exists, so a command from a window manager binding or
+ * a script costs a process start and one round trip, not a GUI start up.
+ *
+ * Exit status: 0 for an "ok" reply, 1 for an error reply, 2 for bad
+ * usage, 3 when no instance runs.
+ */
+class ControlClient
+{
+public:
+    // arguments follow --ctl: [--bench <count>] <command> [<argument>...]
+    static int run(const QString &key, const QStringList &arguments);
+
+private:
+    static int bench(const QString &key, const QByteArray &command, int count);
+};
+
+#endif // CONTROLCLIENT_H
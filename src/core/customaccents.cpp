@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/customaccents.h"
+#include "core/accenttablecache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QStandardPaths>
+
+namespace
+{
+constexpr quint32 CacheMagic = 0x41504341; // "APCA"
+constexpr int ReloadDelayMs = 200;
+
+QStringList tokenize(QStringView line)
+{
+    QStringList tokens;
+    QString current;
+    bool quoted = false;
+    bool hasToken = false;
+
+    for (const QChar c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            hasToken = true;
+        } else if (c.isSpace() && !quoted) {
+            if (hasToken) {
+                tokens.append(current);
+                current.clear();
+                hasToken = false;
+            }
+        } else {
+            current.append(c);
+            hasToken = true;
+        }
+    }
+
+    if (hasToken) {
+        tokens.append(current);
+    }
+
+    return tokens;
+}
+}
+
+CustomAccents* customAccents = &CustomAccents::instance();
+
+CustomAccents::CustomAccents(QObject *parent)
+    : QObject(parent), table(std::make_shared<const Table>())
+{
+    // Editors usually save in several steps (truncate, write, rename),
+    // so coalesce the notifications into a single reload.
+    reloadTimer.setSingleShot(true);
+    reloadTimer.setInterval(ReloadDelayMs);
+
+    connect(&reloadTimer, &QTimer::timeout, this, &CustomAccents::reload);
+}
+
+QString CustomAccents::filePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
+           + QStringLiteral("/customaccents.txt");
+}
+
+QString CustomAccents::cachePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + QStringLiteral("/customaccents.cache");
+}
+
+QStringList CustomAccents::getAccents(char32_t baseChar) const
+{
+    const auto current = table.load();
+
+    return AccentTableCache::lookup(*current, baseChar);
+}
+
+qint64 CustomAccents::memoryUsage() const
+{
+    return AccentTableCache::memoryUsage(*table.load());
+}
+
+void CustomAccents::load()
+{
+    reload();
+}
+
+void CustomAccents::reload()
+{
+    table.store(readTable());
+    watchFile();
+
+    emit reloaded();
+}
+
+void CustomAccents::watchFile()
+{
+    // The file may not exist yet or may have been replaced by a rename,
+    // in which case the watcher silently dropped it.
+    if (!watcher) {
+        watcher = new QFileSystemWatcher(this);
+        connect(watcher, &QFileSystemWatcher::fileChanged, &reloadTimer, qOverload<>(&QTimer::start));
+        connect(watcher, &QFileSystemWatcher::directoryChanged, &reloadTimer, qOverload<>(&QTimer::start));
+    }
+
+    const QString path = filePath();
+    const QString dir = QFileInfo(path).absolutePath();
+
+    if (QFileInfo::exists(dir) && !watcher->directories().contains(dir)) {
+        watcher->addPath(dir);
+    }
+
+    if (QFileInfo::exists(path) && !watcher->files().contains(path)) {
+        watcher->addPath(path);
+    }
+}
+
+std::shared_ptr<const CustomAccents::Table> CustomAccents::readTable() const
+{
+    const AccentTableCache cache(cachePath(), CacheMagic);
+    const AccentTableCache::Source source = AccentTableCache::stat(filePath());
+
+    if (source.size < 0) {
+        return std::make_shared<const Table>();
+    }
+
+    auto result = std::make_shared<Table>();
+
+    // Fast path: the file has not been touched since the cache was written
+    if (cache.sources() == QList{source} && cache.loadIfFresh(*result)) {
+        return result;
+    }
+
+    QFile file(source.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open" << file.fileName();
+        return std::make_shared<const Table>();
+    }
+
+    const QByteArray text = file.readAll();
+    const QByteArray hash = QCryptographicHash::hash(text, QCryptographicHash::Sha1);
+
+    // The file was touched but its content may be the same
+    if (!cache.loadIfHash(hash, *result)) {
+        *result = parse(text);
+    }
+
+    cache.save({source}, hash, *result);
+
+    return result;
+}
+
+CustomAccents::Table CustomAccents::parse(const QByteArray &text)
+{
+    Table result;
+
+    const QString content = QString::fromUtf8(text);
+
+    for (QStringView line : QStringView(content).split(u'\n')) {
+        line = line.trimmed();
+
+        if (line.isEmpty() || line.startsWith(u'#')) {
+            continue;
+        }
+
+        QStringList tokens = tokenize(line);
+        if (tokens.size() < 2) {
+            continue;
+        }
+
+        QString base = tokens.takeFirst();
+        if (base.size() > 1 && base.endsWith(u':')) {
+            base.chop(1);
+        }
+
+        const QList<uint> codePoints = base.toUcs4();
+        if (codePoints.size() != 1 || codePoints[0] > Table::MaxCodePoint) {
+            qWarning() << "Ignoring custom accent entry with invalid base" << base;
+            continue;
+        }
+
+        QStringList &candidates = result[static_cast<char32_t>(codePoints[0])];
+        for (const QString &candidate : std::as_const(tokens)) {
+            if (!candidates.contains(candidate)) {
+                candidates.append(candidate);
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CUSTOMACCENTS_H
+#define CUSTOMACCENTS_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+
+#include "core/accenttablecache.h"
+
+class QFileSystemWatcher;
+
+/*
+ * User defined base -> candidates mappings, read from
+ * <config dir>/customaccents.txt. One mapping per line:
+ *
+ *   # comment
+ *   a: α ∀ ∧
+ *   s: ß "Société Générale"
+ *
+ * The parsed table is stored in a binary cache keyed by the file's
+ * modification time, size and SHA-1 so that startup only parses text
+ * when the file actually changed.
+ */
+class CustomAccents : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Table = AccentTableCache::Table;
+
+    static CustomAccents& instance()
+    {
+        static CustomAccents s_instance;
+        return s_instance;
+    }
+
+    // The strings point into the loaded table and stay valid until the
+    // next load; see AccentTableCache::owned()
+    QStringList getAccents(char32_t baseChar) const;
+    qint64 memoryUsage() const;
+
+    // Loads the table (from cache when possible) and starts watching the file
+    void load();
+
+    QString filePath() const;
+    QString cachePath() const;
+
+signals:
+    void reloaded();
+
+private slots:
+    void reload();
+
+private:
+    explicit CustomAccents(QObject *parent = nullptr);
+
+    std::shared_ptr<const Table> readTable() const;
+    void watchFile();
+
+    static Table parse(const QByteArray &text);
+
+    // Swapped as a whole on reload so readers never see a partial table
+    std::atomic<std::shared_ptr<const Table>> table;
+
+    QFileSystemWatcher *watcher = nullptr;
+    QTimer reloadTimer;
+
+    Q_DISABLE_COPY(CustomAccents)
+};
+
+extern CustomAccents* customAccents;
+
+#endif // CUSTOMACCENTS_H
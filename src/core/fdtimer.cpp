@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/fdtimer.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+FdTimer::FdTimer(QObject *parent)
+    : QObject(parent), timerFd(-1), notifier(nullptr), interval(0), active(false)
+{
+    timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        qWarning() << "Failed to create a timer:" << std::strerror(errno);
+        return;
+    }
+
+    notifier = new QSocketNotifier(timerFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &FdTimer::expired);
+}
+
+FdTimer::~FdTimer()
+{
+    if (timerFd >= 0) {
+        delete notifier;
+        ::close(timerFd);
+    }
+}
+
+void FdTimer::setInterval(int msec)
+{
+    interval = msec;
+}
+
+void FdTimer::start()
+{
+    if (timerFd < 0) {
+        return;
+    }
+
+    // A zero it_value would disarm the timer
+    const int msec = qMax(interval, 1);
+
+    itimerspec value{};
+    value.it_value.tv_sec = msec / 1000;
+    value.it_value.tv_nsec = static_cast<long>(msec % 1000) * 1000000;
+
+    active = ::timerfd_settime(timerFd, 0, &value, nullptr) == 0;
+}
+
+void FdTimer::stop()
+{
+    if (!active) {
+        return;
+    }
+
+    // Disarming also clears an expiration that was not read yet
+    const itimerspec value{};
+    ::timerfd_settime(timerFd, 0, &value, nullptr);
+    active = false;
+}
+
+void FdTimer::expired()
+{
+    quint64 expirations = 0;
+    if (::read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || !active) {
+        return;
+    }
+
+    active = false;
+    emit timeout();
+}
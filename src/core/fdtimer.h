@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FDTIMER_H
+#define FDTIMER_H
+
+#include <QObject>
+
+class QSocketNotifier;
+
+/*
+ * Single shot timer on a timerfd. Starting a QTimer registers a newly
+ * allocated timer with the event dispatcher; starting and stopping this
+ * one is a single syscall, so it can be restarted for every key event.
+ */
+class FdTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FdTimer(QObject *parent = nullptr);
+    ~FdTimer();
+
+    void setInterval(int msec);
+    void start();
+    void stop();
+
+    bool isActive() const
+    {
+        return active;
+    }
+
+signals:
+    void timeout();
+
+private:
+    void expired();
+
+    int timerFd;
+    QSocketNotifier *notifier;
+    int interval;
+    bool active;
+};
+
+#endif // FDTIMER_H
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/keydispatcher.h"
+
+namespace
+{
+// Longer than a key stays down while typing normally
+constexpr int DwellTime = 150;
+}
+
+KeyDispatcher::KeyDispatcher(QObject *parent)
+    : QObject(parent)
+{
+    connect(&queue, &KeyEventQueue::ready, this, &KeyDispatcher::processEvents);
+
+    dwellTimer.setInterval(DwellTime);
+    connect(&dwellTimer, &FdTimer::timeout, this, &KeyDispatcher::dwellElapsed);
+}
+
+void KeyDispatcher::setSpaceKeycode(int keycode)
+{
+    state.setSpaceKeycode(keycode);
+}
+
+void KeyDispatcher::setPickerVisible(bool visible)
+{
+    state.setPickerVisible(visible);
+}
+
+bool KeyDispatcher::isPickerVisible() const
+{
+    return state.isPickerVisible();
+}
+
+void KeyDispatcher::processEvents()
+{
+    KeyEventQueue::Event event;
+    while (queue.pop(event)) {
+        if (event.pressed) {
+            keyPressed(event);
+        } else {
+            keyReleased(event.keycode);
+        }
+    }
+}
+
+void KeyDispatcher::keyPressed(const KeyEventQueue::Event &event)
+{
+    const KeyStateMachine::Actions actions = state.keyPressed(event.keycode, event.character);
+
+    if (actions & KeyStateMachine::Navigate) {
+        emit navigate(event.keysym);
+        return;
+    }
+
+    if (actions & KeyStateMachine::StopDwell) {
+        dwellTimer.stop();
+    }
+    if (actions & KeyStateMachine::StartDwell) {
+        dwellTimer.start();
+    }
+
+    if (actions & KeyStateMachine::Trigger) {
+        emit triggered(state.heldCharacter());
+    }
+}
+
+void KeyDispatcher::keyReleased(int keycode)
+{
+    const char32_t character = state.heldCharacter();
+    const KeyStateMachine::Actions actions = state.keyReleased(keycode);
+
+    if (actions & KeyStateMachine::Release) {
+        emit released(character);
+    }
+    if (actions & KeyStateMachine::StopDwell) {
+        dwellTimer.stop();
+    }
+    if (actions & KeyStateMachine::Discard) {
+        emit discardAccents();
+    }
+}
+
+void KeyDispatcher::dwellElapsed()
+{
+    if (state.dwellElapsed() & KeyStateMachine::Prepare) {
+        emit prepareAccents(state.heldCharacter());
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYDISPATCHER_H
+#define KEYDISPATCHER_H
+
+#include <QObject>
+
+#include "core/fdtimer.h"
+#include "core/keyeventqueue.h"
+#include "core/keystatemachine.h"
+
+/*
+ * The X11-free half of KeyMonitor: drains the key events the record
+ * thread pushed to eventQueue(), runs them through the state machine
+ * and the dwell timer and turns the resulting actions into signals.
+ * Nothing on this path allocates once it is warmed up.
+ */
+class KeyDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KeyDispatcher(QObject *parent = nullptr);
+
+    KeyEventQueue* eventQueue()
+    {
+        return &queue;
+    }
+
+    void setSpaceKeycode(int keycode);
+    void setPickerVisible(bool visible);
+    bool isPickerVisible() const;
+
+public slots:
+    // Called by the dwell timer
+    void dwellElapsed();
+
+signals:
+    // Space was pressed under a held base key with candidates
+    void triggered(char32_t character);
+    // The base key went up while the picker is visible
+    void released(char32_t character);
+
+    void prepareAccents(char32_t character);
+    void discardAccents();
+
+    // A key pressed while the picker is visible, as its X keysym
+    void navigate(quint32 keysym);
+
+private slots:
+    void processEvents();
+
+private:
+    void keyPressed(const KeyEventQueue::Event &event);
+    void keyReleased(int keycode);
+
+    KeyEventQueue queue;
+    FdTimer dwellTimer;
+    KeyStateMachine state;
+};
+
+#endif // KEYDISPATCHER_H
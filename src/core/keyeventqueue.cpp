@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/keyeventqueue.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+KeyEventQueue::KeyEventQueue(QObject *parent)
+    : QObject(parent), eventFd(-1), notifier(nullptr)
+{
+    eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        qWarning() << "Failed to create the key event queue:" << std::strerror(errno);
+        return;
+    }
+
+    notifier = new QSocketNotifier(eventFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &KeyEventQueue::wake);
+}
+
+KeyEventQueue::~KeyEventQueue()
+{
+    if (eventFd >= 0) {
+        delete notifier;
+        ::close(eventFd);
+    }
+}
+
+void KeyEventQueue::push(const Event &event)
+{
+    const quint32 position = head.load(std::memory_order_relaxed);
+    if (position - tail.load(std::memory_order_acquire) >= Capacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    events[position % Capacity] = event;
+    head.store(position + 1, std::memory_order_release);
+
+    // Written for every event; skipping it when the ring looked non-empty
+    // could lose the wakeup of a consumer that is just draining
+    if (eventFd >= 0) {
+        const quint64 one = 1;
+        while (::write(eventFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+}
+
+void KeyEventQueue::pushKey(int keycode, bool pressed, quint32 keysym)
+{
+    Event event;
+    event.keycode = keycode;
+    event.pressed = pressed;
+    if (pressed) {
+        event.character = keysymToUcs4(keysym);
+        event.keysym = keysym;
+    }
+    push(event);
+}
+
+// Latin-1 keysyms equal their code point and Unicode keysyms carry it in
+// the low bits; legacy keysyms outside those ranges produce no base char.
+char32_t KeyEventQueue::keysymToUcs4(quint32 keysym)
+{
+    if ((keysym >= 0x0020 && keysym <= 0x007e) || (keysym >= 0x00a0 && keysym <= 0x00ff)) {
+        return static_cast<char32_t>(keysym);
+    }
+
+    if (keysym >= 0x01000100 && keysym <= 0x0110ffff) {
+        return static_cast<char32_t>(keysym & 0x00ffffff);
+    }
+
+    return 0;
+}
+
+bool KeyEventQueue::pop(Event &event)
+{
+    const quint32 position = tail.load(std::memory_order_relaxed);
+    if (position == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    event = events[position % Capacity];
+    tail.store(position + 1, std::memory_order_release);
+
+    return true;
+}
+
+void KeyEventQueue::wake()
+{
+    // Resets the counter before draining, so later pushes wake us again
+    quint64 count = 0;
+    while (::read(eventFd, &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+
+    emit ready();
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYEVENTQUEUE_H
+#define KEYEVENTQUEUE_H
+
+#include <QObject>
+
+#include <array>
+#include <atomic>
+
+class QSocketNotifier;
+
+/*
+ * Key events from the record thread to the GUI thread without a heap
+ * allocation per event, which a queued signal costs: a fixed ring with
+ * one producer and one consumer, and an eventfd that wakes the event
+ * loop of the consumer. Events that do not fit are dropped and counted.
+ */
+class KeyEventQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Event {
+        int keycode = 0;
+        // Unicode code point the key produces, or 0 if none
+        char32_t character = 0;
+        quint32 keysym = 0;
+        bool pressed = false;
+    };
+
+    static constexpr quint32 Capacity = 256;
+
+    explicit KeyEventQueue(QObject *parent = nullptr);
+    ~KeyEventQueue();
+
+    // Producer side, from one thread at a time
+    void push(const Event &event);
+    // What the record thread pushes for a key: the character is derived
+    // from keysym for presses, releases carry the keycode only
+    void pushKey(int keycode, bool pressed, quint32 keysym);
+
+    // Code point a keysym produces, or 0 for keysyms without one
+    static char32_t keysymToUcs4(quint32 keysym);
+
+    // Consumer side, from the thread the queue lives in
+    bool pop(Event &event);
+
+    quint64 droppedCount() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+signals:
+    // Events were pushed; pop() them until it returns false
+    void ready();
+
+private:
+    void wake();
+
+    std::array<Event, Capacity> events;
+    // Next slot to write and to read, wrapping at 2^32
+    std::atomic<quint32> head{0};
+    std::atomic<quint32> tail{0};
+    std::atomic<quint64> dropped{0};
+
+    int eventFd;
+    QSocketNotifier *notifier;
+};
+
+#endif // KEYEVENTQUEUE_H
@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QTimer>
 #include <QScreen>
 #include <QCursor>
 #include <QClipboard>
@@ -6,10 +7,7 @@
 #include <QUrl>
 
 #include "keymonitor.h"
-#include "config/configkeys.h"
-#include "config/appconfig.h"
 #include "platform/x11/x11platformwindow.h"
-#include "core/accentmap.h"
 
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
@@ -20,8 +18,47 @@
 
 #include <chrono>
 
-KeyMonitorThread::KeyMonitorThread(QObject *parent)
-    : QThread(parent), display(nullptr), dataDisplay(nullptr),
+namespace
+{
+int keysymToNavigationKey(quint32 keysym)
+{
+    // Digits and letters select a candidate by its label
+    if ((keysym >= XK_0 && keysym <= XK_9) || (keysym >= XK_A && keysym <= XK_Z)) {
+        return static_cast<int>(keysym);
+    }
+    if (keysym >= XK_a && keysym <= XK_z) {
+        return static_cast<int>(keysym - XK_a + XK_A);
+    }
+
+    switch (keysym) {
+    case XK_Right:
+        return Qt::Key_Right;
+    case XK_Left:
+        return Qt::Key_Left;
+    case XK_Up:
+        return Qt::Key_Up;
+    case XK_Down:
+        return Qt::Key_Down;
+    case XK_space:
+        return Qt::Key_Space;
+    case XK_Return:
+    case XK_KP_Enter:
+        return Qt::Key_Return;
+    case XK_Escape:
+        return Qt::Key_Escape;
+    case XK_slash:
+    case XK_KP_Divide:
+        return Qt::Key_Slash;
+    case XK_BackSpace:
+        return Qt::Key_Backspace;
+    default:
+        return 0;
+    }
+}
+}
+
+KeyMonitorThread::KeyMonitorThread(KeyEventQueue *queue, QObject *parent)
+    : QThread(parent), queue(queue), display(nullptr), dataDisplay(nullptr),
       context(0), running(false)
 {
 }
@@ -67,13 +104,7 @@ void KeyMonitorThread::eventCallback(void* closure, void *rawData)
 
         KeySym keysym = XkbKeycodeToKeysym(self->display, keycode, 0, level);
 
-        QString keysymStr = QString::fromLatin1(XKeysymToString(keysym));
-
-        if (pressed) {
-            emit self->keyPressed(keycode, keysymStr);
-        } else {
-            emit self->keyReleased(keycode);
-        }
+        self->queue->pushKey(keycode, pressed, static_cast<quint32>(keysym));
     }
 
     XRecordFreeData(data);
@@ -116,9 +147,11 @@ void KeyMonitorThread::run()
     }
 
     running = true;
-    XRecordEnableContextAsync(dataDisplay, context,
-                              reinterpret_cast<XRecordInterceptProc>(eventCallback),
-                              reinterpret_cast<XPointer>(this));
+    if (XRecordEnableContextAsync(dataDisplay, context,
+                                  reinterpret_cast<XRecordInterceptProc>(eventCallback),
+                                  reinterpret_cast<XPointer>(this))) {
+        emit recording();
+    }
 
     while (running) {
         XRecordProcessReplies(dataDisplay);
@@ -158,20 +191,37 @@ int KeyMonitorThread::spaceKeyCode() const
 }
 
 KeyMonitor::KeyMonitor(QObject *parent)
-    : QObject(parent), currentKeycode(-1), keyIsHeld(false)
+    : QObject(parent), fakeDisplay(nullptr), lastWindow(0)
 {
 
-    monitorThread = new KeyMonitorThread(this);
+    monitorThread = new KeyMonitorThread(dispatcher.eventQueue(), this);
 
-    connect(monitorThread, &KeyMonitorThread::keyPressed,
-            this, &KeyMonitor::handleKeyPress);
-    connect(monitorThread, &KeyMonitorThread::keyReleased,
-            this, &KeyMonitor::handleKeyRelease);
+    connect(monitorThread, &KeyMonitorThread::recording, this, [this]() {
+        // Known once the thread opened its display
+        dispatcher.setSpaceKeycode(monitorThread->spaceKeyCode());
+    });
+    connect(monitorThread, &KeyMonitorThread::recording,
+            this, &KeyMonitor::recording);
+
+    connect(&dispatcher, &KeyDispatcher::triggered, this, &KeyMonitor::handleTrigger);
+    connect(&dispatcher, &KeyDispatcher::released, this, [this](char32_t character) {
+        emit keyEvent(false, character);
+    });
+    connect(&dispatcher, &KeyDispatcher::navigate, this, &KeyMonitor::handleNavigate);
+    connect(&dispatcher, &KeyDispatcher::prepareAccents, this, &KeyMonitor::prepareAccents);
+    connect(&dispatcher, &KeyDispatcher::discardAccents, this, &KeyMonitor::discardAccents);
 }
 
 KeyMonitor::~KeyMonitor()
 {
     stop();
+
+    // The thread holds a pointer to the queue
+    monitorThread->wait();
+
+    if (fakeDisplay) {
+        XCloseDisplay(fakeDisplay);
+    }
 }
 
 void KeyMonitor::setActive(bool enabled)
@@ -193,66 +243,37 @@ void KeyMonitor::stop()
     monitorThread->stop();
 }
 
-void KeyMonitor::handleKeyPress(int keycode, const QString &character)
+bool KeyMonitor::isRunning() const
 {
-    if(character.isEmpty()) {
-        return;
-    }
-
-    bool isSpaceKeycode = monitorThread->spaceKeyCode() == keycode;
-
-    if(keyIsHeld && !isAccentPickerVisible && isSpaceKeycode) {
-
-        if(currentChar.isEmpty()) {
-            return;
-        }
-
-        QStringList accents = AccentMap::getAccents(currentChar[0], appConfig->get<ConfigKey::SelectedCharacterSets>());
-
-        if(accents.isEmpty()) {
-            return;
-        }
-
-        // removes the space key
-        simulateBackspace();
-
-        checkKeyHold();
-    } else {
-
-        if (!keyIsHeld && character.length() == 1 ) {
-            currentKeycode = keycode;
-            currentChar = character[0];
-            keyIsHeld = true;
-        }
-    }
+    return monitorThread->isRunning();
 }
 
-void KeyMonitor::handleKeyRelease(int keycode)
+void KeyMonitor::handleTrigger(char32_t character)
 {
-    if (keycode == currentKeycode) {
+    // removes the space key
+    simulateBackspace();
 
-        if(isAccentPickerVisible) {
-            emit keyEvent(false, currentChar);
-        }
-        currentKeycode = UN_INIT;
-        keyIsHeld = false;
-        currentChar.clear();
-    }
+    lastWindow = getCurrentWindow();
+
+    emit keyEvent(true, character);
 }
 
-void KeyMonitor::checkKeyHold()
+void KeyMonitor::handleNavigate(quint32 keysym)
 {
-    if (currentKeycode != UN_INIT && !currentChar.isEmpty()) {
-
-        lastWindow = getCurrentWindow();
-
-        emit keyEvent(true, currentChar);
+    if (const int key = keysymToNavigationKey(keysym)) {
+        emit navigationKey(key);
     }
 }
 
 void KeyMonitor::accentPickerVisible(bool isVisible)
 {
-    isAccentPickerVisible = isVisible;
+    dispatcher.setPickerVisible(isVisible);
+
+    if (isVisible) {
+        keyboardGrab.grab();
+    } else {
+        keyboardGrab.release();
+    }
 }
 
 QPoint KeyMonitor::getCursorPosition()
@@ -262,17 +283,21 @@ QPoint KeyMonitor::getCursorPosition()
 
 void KeyMonitor::simulateBackspace()
 {
-    Display *display =  XOpenDisplay(nullptr);
-    if (!display) {
-        return;
+    // Kept open, a new connection per trigger costs a handshake
+    if (!fakeDisplay) {
+        fakeDisplay = XOpenDisplay(nullptr);
+        if (!fakeDisplay) {
+            return;
+        }
     }
 
-    KeyCode backspace = XKeysymToKeycode(display, XK_BackSpace);
+    KeyCode backspace = XKeysymToKeycode(fakeDisplay, XK_BackSpace);
 
-    XTestFakeKeyEvent(display, backspace, True, 0);
-    XTestFakeKeyEvent(display, backspace, False, 0);
-    XFlush(display);
-    XCloseDisplay(display);
+    XTestFakeKeyEvent(fakeDisplay, backspace, True, 0);
+    XTestFakeKeyEvent(fakeDisplay, backspace, False, 0);
+    // Processed before the keyboard is grabbed on another connection,
+    // which would otherwise swallow the backspace
+    XSync(fakeDisplay, False);
 }
 
 static QMimeData* cloneMimeData(const QMimeData* src)
@@ -336,14 +361,30 @@ void KeyMonitor::withClipboardBackup(const QString &injectedText, const std::fun
     });
 }
 
-void KeyMonitor::insertText(const QString &text)
+void KeyMonitor::insertText(const QString &text, bool replaceTyped)
 {
+    // The paste has to reach the focused window
+    keyboardGrab.release();
+
+    if (!replaceTyped) {
+        pasteText(text);
+        return;
+    }
+
     withClipboardBackup(text, [&]() {
 
+        // The picker never took the focus, so the window is still active
         X11PlatformWindow window(lastWindow);
-        window.raise();
 
         simulateBackspace();
-        window.pasteClipboard();
+        window.pasteClipboard(false);
+    });
+}
+
+void KeyMonitor::pasteText(const QString &text)
+{
+    withClipboardBackup(text, [&]() {
+        X11PlatformWindow window(getCurrentWindow());
+        window.pasteClipboard(false);
     });
 }
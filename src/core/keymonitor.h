@@ -4,29 +4,32 @@
 #define KEYMONITOR_H
 
 #include <QObject>
-#include <QTimer>
 #include <QThread>
 #include <atomic>
 
+#include "core/keydispatcher.h"
+#include "platform/x11/x11keyboardgrab.h"
+
 struct _XDisplay;
 typedef struct _XDisplay Display;
 using XRecordContext = unsigned long;
 
-// uninitialized
-inline constexpr int UN_INIT = -1;
-
 namespace X11Events
 {
 inline constexpr int KeyPressEvent = 2;
 inline constexpr int KeyReleaseEvent = 3;
 }
 
+/*
+ * Records the key events of every client through XRecord and pushes
+ * them to queue, which KeyDispatcher drains on the GUI thread.
+ */
 class KeyMonitorThread : public QThread
 {
     Q_OBJECT
 
 public:
-    explicit KeyMonitorThread(QObject *parent = nullptr);
+    explicit KeyMonitorThread(KeyEventQueue *queue, QObject *parent = nullptr);
     ~KeyMonitorThread();
 
     void run() override;
@@ -34,12 +37,13 @@ public:
     int spaceKeyCode() const;
 
 signals:
-    void keyPressed(int keycode, const QString &keysym);
-    void keyReleased(int keycode);
+    // The record context is enabled and key events flow
+    void recording();
 
 private:
     static void eventCallback(void* closure, void *data);
 
+    KeyEventQueue *queue;
     Display *display;
     Display *dataDisplay;
     XRecordContext context;
@@ -59,31 +63,44 @@ public:
 
     bool start();
     void stop();
+    bool isRunning() const;
     void setActive(bool enabled);
 
 public slots:
-    void insertText(const QString &text);
+    // Replaces the typed base key with text unless replaceTyped is false
+    void insertText(const QString &text, bool replaceTyped = true);
+    // Pastes text into the focused window without replacing a typed key
+    void pasteText(const QString &text);
     void accentPickerVisible(bool isVisible);
 
 signals:
-    void keyEvent(bool isPressed, const QString &character);
+    void keyEvent(bool isPressed, char32_t character);
+
+    // A base key was held past the typing dwell time, a trigger may follow
+    void prepareAccents(char32_t character);
+    void discardAccents();
+
+    // A navigation key (a Qt::Key) pressed while the picker is visible
+    void navigationKey(int key);
+
+    void recording();
 
 private slots:
-    void handleKeyPress(int keycode, const QString &keysym);
-    void handleKeyRelease(int keycode);
-    void checkKeyHold();
+    void handleTrigger(char32_t character);
+    void handleNavigate(quint32 keysym);
 
 private:
     QPoint getCursorPosition();
     void simulateBackspace();
     void withClipboardBackup(const QString& injectedText, const std::function<void()>& operation);
 
+    KeyDispatcher dispatcher;
     KeyMonitorThread *monitorThread;
+    // Keeps navigation keys away from the focused window while the picker is up
+    X11KeyboardGrab keyboardGrab;
+    // For the XTest events, opened on first use
+    Display *fakeDisplay;
 
-    int currentKeycode;
-    QString currentChar;
-    bool keyIsHeld;
-    bool isAccentPickerVisible = false;
     unsigned long lastWindow;
 };
 
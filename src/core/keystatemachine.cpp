@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/keystatemachine.h"
+#include "core/accentmap.h"
+
+#include <QChar>
+
+KeyStateMachine::Actions KeyStateMachine::keyPressed(int keycode, char32_t character)
+{
+    if (pickerVisible) {
+        // Auto-repeat of the held base key is not a selection
+        return keycode == heldKeycode ? NoAction : Navigate;
+    }
+
+    if (character == 0) {
+        return NoAction;
+    }
+
+    if (held && keycode == spaceKeycode) {
+        if (heldChar == 0 || AccentMap::getAccents(heldChar, AccentMap::selectedLanguages()).isEmpty()) {
+            return NoAction;
+        }
+
+        prepared = false;
+        return StopDwell | Trigger;
+    }
+
+    if (!held && !QChar::isSpace(character) && QChar::isPrint(character)) {
+        heldKeycode = keycode;
+        heldChar = character;
+        held = true;
+        return StartDwell;
+    }
+
+    return NoAction;
+}
+
+KeyStateMachine::Actions KeyStateMachine::keyReleased(int keycode)
+{
+    if (keycode != heldKeycode) {
+        return NoAction;
+    }
+
+    Actions actions = StopDwell;
+    if (pickerVisible) {
+        actions |= Release;
+    }
+    if (prepared) {
+        prepared = false;
+        actions |= Discard;
+    }
+
+    heldKeycode = UN_INIT;
+    heldChar = 0;
+    held = false;
+
+    return actions;
+}
+
+KeyStateMachine::Actions KeyStateMachine::dwellElapsed()
+{
+    if (!held || pickerVisible || heldChar == 0) {
+        return NoAction;
+    }
+
+    prepared = true;
+    return Prepare;
+}
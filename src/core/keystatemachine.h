@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYSTATEMACHINE_H
+#define KEYSTATEMACHINE_H
+
+#include <QFlags>
+#include <QtGlobal>
+
+// uninitialized
+inline constexpr int UN_INIT = -1;
+
+/*
+ * Hold and trigger logic of KeyMonitor, without X11 and timers. A
+ * printable key pressed while no other is held becomes the base key and
+ * starts the dwell; Space while it is held triggers the picker if the
+ * base has candidates. While the picker is visible every other key is
+ * for navigation. Each event returns the actions the monitor performs.
+ */
+class KeyStateMachine
+{
+public:
+    enum Action {
+        NoAction = 0x00,
+        StartDwell = 0x01,
+        StopDwell = 0x02,
+        // Lay out the picker for heldCharacter() ahead of a trigger
+        Prepare = 0x04,
+        Discard = 0x08,
+        // Erase the typed space and show the picker for heldCharacter()
+        Trigger = 0x10,
+        // A key for the visible picker
+        Navigate = 0x20,
+        // The base key went up while the picker is visible
+        Release = 0x40,
+    };
+    Q_DECLARE_FLAGS(Actions, Action)
+
+    void setSpaceKeycode(int keycode)
+    {
+        spaceKeycode = keycode;
+    }
+
+    void setPickerVisible(bool visible)
+    {
+        pickerVisible = visible;
+    }
+
+    bool isPickerVisible() const
+    {
+        return pickerVisible;
+    }
+
+    // The base key currently held, or 0
+    char32_t heldCharacter() const
+    {
+        return heldChar;
+    }
+
+    // character is the code point the key produces, or 0 if none
+    Actions keyPressed(int keycode, char32_t character);
+    Actions keyReleased(int keycode);
+    Actions dwellElapsed();
+
+private:
+    int spaceKeycode = UN_INIT;
+    int heldKeycode = UN_INIT;
+    char32_t heldChar = 0;
+    bool held = false;
+    bool prepared = false;
+    bool pickerVisible = false;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KeyStateMachine::Actions)
+
+#endif // KEYSTATEMACHINE_H
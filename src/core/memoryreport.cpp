@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/memoryreport.h"
+
+#include <QFile>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+// Fields of /proc/self/status, all reported in kB
+constexpr const char *StatusFields[] = {"VmRSS", "VmHWM", "RssAnon", "RssFile", "RssShmem"};
+}
+
+MemoryReport::MemoryReport()
+    : resident(0)
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> lines = status.readAll().split('\n');
+        for (const char *field : StatusFields) {
+            const QByteArray prefix = QByteArray(field) + ':';
+            for (const QByteArray &line : lines) {
+                if (!line.startsWith(prefix)) {
+                    continue;
+                }
+
+                // e.g. "VmRSS:	   23456 kB"
+                const qint64 bytes = line.mid(prefix.size()).simplified().split(' ').value(0).toLongLong() * 1024;
+                entries.append({QByteArray(field).toLower(), bytes});
+                if (prefix == "VmRSS:") {
+                    resident = bytes;
+                }
+                break;
+            }
+        }
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 heap = mallinfo2();
+    entries.append({QByteArrayLiteral("heapused"), static_cast<qint64>(heap.uordblks + heap.hblkhd)});
+    entries.append({QByteArrayLiteral("heapfree"), static_cast<qint64>(heap.fordblks)});
+#endif
+}
+
+void MemoryReport::add(const char *name, qint64 bytes)
+{
+    entries.append({QByteArray(name), bytes});
+}
+
+QByteArray MemoryReport::toLine() const
+{
+    QByteArray line;
+    for (const auto &entry : entries) {
+        if (!line.isEmpty()) {
+            line += ' ';
+        }
+        line += entry.first + '=' + QByteArray::number((entry.second + 1023) / 1024);
+    }
+
+    return line;
+}
+
+void MemoryReport::trimHeap()
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+
+/*
+ * Snapshot of the memory of this process: the kernel's view from
+ * /proc/self/status, the heap as seen by malloc and the estimates added
+ * by the components that hold caches. toLine() gives key=value pairs in
+ * KiB on one line, so scripts can check them against a budget.
+ */
+class MemoryReport
+{
+public:
+    MemoryReport();
+
+    // Adds the estimate of a component, in bytes
+    void add(const char *name, qint64 bytes);
+
+    qint64 residentBytes() const
+    {
+        return resident;
+    }
+
+    QByteArray toLine() const;
+
+    // Gives free heap pages back to the system
+    static void trimHeap();
+
+private:
+    qint64 resident;
+    QList<QPair<QByteArray, qint64>> entries;
+};
+
+#endif // MEMORYREPORT_H
@@ -1,36 +1,57 @@
 #include "singleinstance.h"
 
-#include <QCryptographicHash>
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
 
 namespace
 {
+constexpr int ReplyTimeout = 2000; // ms
+constexpr int MaxLineLength = 64 * 1024;
 
-QString generateKeyHash( const QString& key, const QString& salt )
+// Abstract names start with a NUL byte and are not NUL terminated
+socklen_t socketAddress(const QString &key, sockaddr_un &address)
 {
-    QByteArray data;
+    const QByteArray name = '\0' + key.toUtf8() + '-' + QByteArray::number(getuid()) + '-' + qgetenv("DISPLAY");
 
-    data.append( key.toUtf8() );
-    data.append( salt.toUtf8() );
-    data = QCryptographicHash::hash( data, QCryptographicHash::Sha1 ).toHex();
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
 
-    return data;
-}
+    const size_t length = qMin(static_cast<size_t>(name.size()), sizeof(address.sun_path));
+    std::memcpy(address.sun_path, name.constData(), length);
 
+    return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length);
 }
 
-SingleInstance::SingleInstance( const QString& key )
-    : key( key )
-    , memLockKey( generateKeyHash( key, "_memLockKey" ) )
-    , sharedmemKey( generateKeyHash( key, "_sharedmemKey" ) )
-    , sharedMem( sharedmemKey )
-    , memLock( memLockKey, 1 )
+bool writeAll(int fd, const QByteArray &data)
 {
-    memLock.acquire();
-    {
-        QSharedMemory fix( sharedmemKey );    // Fix for *nix: http://habrahabr.ru/post/173281/
-        fix.attach();
+    qsizetype written = 0;
+    while (written < data.size()) {
+        const ssize_t result = ::send(fd, data.constData() + written, static_cast<size_t>(data.size() - written),
+                                      MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        written += result;
     }
-    memLock.release();
+    return true;
+}
+}
+
+SingleInstance::SingleInstance(const QString &key, QObject *parent)
+    : QObject(parent), key(key), listener(-1), notifier(nullptr)
+{
 }
 
 SingleInstance::~SingleInstance()
@@ -38,40 +59,212 @@ SingleInstance::~SingleInstance()
     release();
 }
 
-bool SingleInstance::isAnotherRunning()
+bool SingleInstance::run()
 {
-    if ( sharedMem.isAttached() )
-        return false;
+    if (listener >= 0) {
+        return true;
+    }
 
-    memLock.acquire();
-    const bool isRunning = sharedMem.attach();
-    if ( isRunning )
-        sharedMem.detach();
-    memLock.release();
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        qWarning() << "Failed to create the instance socket:" << std::strerror(errno);
+        return true;
+    }
 
-    return isRunning;
-}
+    sockaddr_un address;
+    const socklen_t length = socketAddress(key, address);
 
-bool SingleInstance::run()
-{
-    if ( isAnotherRunning() )   // Extra check
-        return false;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), length) != 0) {
+        const int error = errno;
+        ::close(fd);
+
+        if (error == EADDRINUSE) {
+            return false;
+        }
+
+        // Running without the guarantee beats not running at all
+        qWarning() << "Failed to bind the instance socket:" << std::strerror(error);
+        return true;
+    }
 
-    memLock.acquire();
-    const bool result = sharedMem.create( sizeof( quint64 ) );
-    memLock.release();
-    if ( !result ) {
-        release();
-        return false;
+    if (::listen(fd, SOMAXCONN) != 0) {
+        qWarning() << "Failed to listen on the instance socket:" << std::strerror(errno);
+        ::close(fd);
+        return true;
     }
 
+    listener = fd;
+    notifier = new QSocketNotifier(listener, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &SingleInstance::acceptConnections);
+
     return true;
 }
 
 void SingleInstance::release()
 {
-    memLock.acquire();
-    if ( sharedMem.isAttached() )
-        sharedMem.detach();
-    memLock.release();
+    const QList<int> fds = connections.keys();
+    for (int fd : fds) {
+        closeConnection(fd);
+    }
+
+    if (listener >= 0) {
+        delete notifier;
+        notifier = nullptr;
+        ::close(listener);
+        listener = -1;
+    }
+}
+
+void SingleInstance::setHandler(const Handler &handler)
+{
+    this->handler = handler;
+}
+
+void SingleInstance::acceptConnections()
+{
+    for (;;) {
+        const int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        // The abstract namespace has no file permissions to rely on
+        ucred credentials{};
+        socklen_t length = sizeof(credentials);
+        if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0
+                || credentials.uid != getuid()) {
+            ::close(fd);
+            continue;
+        }
+
+        Connection &connection = connections[fd];
+        connection.notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(connection.notifier, &QSocketNotifier::activated, this, [this, fd]() {
+            readConnection(fd);
+        });
+    }
+}
+
+void SingleInstance::readConnection(int fd)
+{
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+
+    char chunk[4096];
+    for (;;) {
+        const ssize_t result = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (result > 0) {
+            it->buffer.append(chunk, result);
+            continue;
+        }
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+
+        // End of stream or error; lines without a newline are dropped
+        closeConnection(fd);
+        return;
+    }
+
+    qsizetype newline;
+    while ((newline = it->buffer.indexOf('\n')) >= 0) {
+        const QByteArray command = it->buffer.left(newline);
+        it->buffer.remove(0, newline + 1);
+
+        QByteArray reply = handler ? handler(command) : QByteArrayLiteral("error no handler");
+        reply.replace('\n', ' ');
+
+        if (!writeAll(fd, reply + '\n')) {
+            closeConnection(fd);
+            return;
+        }
+
+        // The handler may have released the instance
+        it = connections.find(fd);
+        if (it == connections.end()) {
+            return;
+        }
+    }
+
+    if (it->buffer.size() > MaxLineLength) {
+        qWarning() << "Dropping a client that sent an overlong command";
+        closeConnection(fd);
+    }
+}
+
+void SingleInstance::closeConnection(int fd)
+{
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+
+    delete it->notifier;
+    connections.erase(it);
+    ::close(fd);
+}
+
+std::optional<QByteArrayList> SingleInstance::send(const QString &key, const QByteArrayList &commands)
+{
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    sockaddr_un address;
+    const socklen_t length = socketAddress(key, address);
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), length) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    QByteArrayList replies;
+    QByteArray received;
+
+    for (const QByteArray &command : commands) {
+        QByteArray line = command;
+        line.replace('\n', ' ');
+        line.append('\n');
+
+        if (!writeAll(fd, line)) {
+            ::close(fd);
+            return std::nullopt;
+        }
+
+        // One reply line per command
+        qsizetype newline;
+        while ((newline = received.indexOf('\n')) < 0) {
+            pollfd readable{fd, POLLIN, 0};
+            if (::poll(&readable, 1, ReplyTimeout) <= 0) {
+                ::close(fd);
+                return std::nullopt;
+            }
+
+            char chunk[4096];
+            const ssize_t result = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                ::close(fd);
+                return std::nullopt;
+            }
+            received.append(chunk, result);
+        }
+
+        replies.append(received.left(newline));
+        received.remove(0, newline + 1);
+    }
+
+    ::close(fd);
+    return replies;
 }
@@ -1,35 +1,64 @@
 #ifndef SINGLEINSTANCE_H
 #define SINGLEINSTANCE_H
 
-/*
- * Code from this Stack Overflow answer: https://stackoverflow.com/a/28172162/11337328
-*/
-
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QHash>
 #include <QObject>
-#include <QSharedMemory>
-#include <QSystemSemaphore>
+#include <QString>
+
+#include <functional>
+#include <optional>
 
+class QSocketNotifier;
 
-class SingleInstance
+/*
+ * One instance per user and X display, enforced by a listening Unix
+ * socket in the abstract namespace. The kernel drops the name with the
+ * last descriptor, so a crashed instance leaves nothing stale behind, and
+ * the name includes the uid and $DISPLAY, so sessions on a shared server
+ * do not see each other. Connections from other users are refused.
+ *
+ * The socket also carries commands: every line a client sends is passed
+ * to the handler and its return value is sent back as one line.
+ */
+class SingleInstance : public QObject
 {
+    Q_OBJECT
 
 public:
-    SingleInstance( const QString& key );
+    using Handler = std::function<QByteArray(const QByteArray &command)>;
+
+    explicit SingleInstance(const QString &key, QObject *parent = nullptr);
     ~SingleInstance();
 
-    bool isAnotherRunning();
+    // Starts listening; false if another instance already does
     bool run();
     void release();
 
+    void setHandler(const Handler &handler);
+
+    // Sends each command to the running instance and returns the replies,
+    // or std::nullopt if there is none. Does not need a QCoreApplication.
+    static std::optional<QByteArrayList> send(const QString &key, const QByteArrayList &commands);
+
 private:
-    const QString key;
-    const QString memLockKey;
-    const QString sharedmemKey;
+    struct Connection {
+        QSocketNotifier *notifier = nullptr;
+        QByteArray buffer;
+    };
 
-    QSharedMemory sharedMem;
-    QSystemSemaphore memLock;
+    void acceptConnections();
+    void readConnection(int fd);
+    void closeConnection(int fd);
+
+    const QString key;
+    int listener;
+    QSocketNotifier *notifier;
+    QHash<int, Connection> connections;
+    Handler handler;
 
-    Q_DISABLE_COPY( SingleInstance )
+    Q_DISABLE_COPY(SingleInstance)
 };
 
 #endif // SINGLEINSTANCE_H
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "core/startupprofile.h"
+
+#include <QElapsedTimer>
+
+#include <cstdio>
+
+namespace
+{
+QElapsedTimer timer;
+qint64 previous = 0;
+}
+
+void StartupProfile::start()
+{
+    timer.start();
+    previous = 0;
+}
+
+bool StartupProfile::isEnabled()
+{
+    return timer.isValid();
+}
+
+void StartupProfile::mark(const char *phase)
+{
+    if (!timer.isValid()) {
+        return;
+    }
+
+    const qint64 now = timer.nsecsElapsed();
+    std::fprintf(stderr, "startup: %-24s %8.2f ms  (at %8.2f ms)\n", phase, (now - previous) / 1e6, now / 1e6);
+    previous = now;
+}
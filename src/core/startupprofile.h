@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+/*
+ * Start up timings, printed to stderr with --startup-profile. Each mark()
+ * reports the time spent since the previous mark and since start().
+ */
+class StartupProfile
+{
+public:
+    static void start();
+    static bool isEnabled();
+    static void mark(const char *phase);
+};
+
+#endif // STARTUPPROFILE_H
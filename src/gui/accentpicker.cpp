@@ -1,169 +1,302 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "gui/accentpicker.h"
+#include "gui/accentstriprenderer.h"
+#include "gui/widgetaccentpopup.h"
 #include "core/accentmap.h"
+#include "core/accentsearch.h"
+#include "core/memoryreport.h"
 #include "config/appconfig.h"
 #include "config/configkeys.h"
 
-#include <QKeyEvent>
 #include <QApplication>
+#include <QCursor>
+#include <QElapsedTimer>
 #include <QScreen>
 
-AccentButton::AccentButton(const QString &text, int index, QWidget *parent)
-    : QLabel(text, parent), index(index), highlighted(false)
+// Last, the X11 headers define macros that clash with Qt
+#include "platform/x11/x11accentpopup.h"
+
+// Enable with QT_LOGGING_RULES="accentpicker.latency.debug=true"
+Q_LOGGING_CATEGORY(lcLatency, "accentpicker.latency", QtWarningMsg)
+
+namespace
 {
+// Distance between the caret and the popup
+constexpr int CaretGap = 6;
+// Time without a popup before low footprint mode frees its resources
+constexpr int IdleTrimDelayMs = 30000;
 
-    setAlignment(Qt::AlignCenter);
-    setMinimumSize(40, 40);
-    setCursor(Qt::PointingHandCursor);
-    updateStyle();
+AccentPopup* createPopup(QObject *parent)
+{
+    if (appConfig->get<ConfigKey::PopupBackend>() == QLatin1String("x11")) {
+        if (AccentPopup *popup = X11AccentPopup::create(parent)) {
+            return popup;
+        }
+        qWarning() << "Falling back to the widget popup";
+    }
+
+    return new WidgetAccentPopup(parent);
+}
 }
 
-void AccentButton::setHighlighted(bool highlighted)
+AccentPicker::AccentPicker(QObject *parent)
+    : AccentPicker(createPopup(nullptr), parent)
 {
-    this->highlighted = highlighted;
-    updateStyle();
 }
 
-void AccentButton::updateStyle()
+AccentPicker::AccentPicker(AccentPopup *popup, QObject *parent)
+    : QObject(parent), popup(popup), searching(false), triggered(false), currentIndex(-1), prepared(false), showCount(0), preparedChar(0)
 {
-    QString bgColor = highlighted ? "#4A90E2" : "#2C2C2C";
-    QString textColor = highlighted ? "#FFFFFF" : "#CCCCCC";
-
-    setStyleSheet(QString(
-                      "QLabel {"
-                      "    background-color: %1;"
-                      "    color: %2;"
-                      "    border-radius: 6px;"
-                      "    font-size: 20px;"
-                      "    font-weight: bold;"
-                      "    padding: 8px;"
-                      "}"
-                  ).arg(bgColor, textColor));
+    popup->setParent(this);
+
+    connect(popup, &AccentPopup::hovered, this, &AccentPicker::handleButtonHover);
+    connect(popup, &AccentPopup::clicked, this, &AccentPicker::handleAccentSelected);
+    connect(&caretLocator, &CaretLocator::caretFound, this, &AccentPicker::caretFound);
+
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(IdleTrimDelayMs);
+    connect(&idleTimer, &QTimer::timeout, this, &AccentPicker::trimMemory);
+
+    appConfig->onChanged<ConfigKey::LowFootprint>(this, [this](bool lowFootprint) {
+        if (!lowFootprint) {
+            idleTimer.stop();
+        } else if (!isVisible()) {
+            idleTimer.start();
+        }
+    });
 }
 
-AccentPicker::AccentPicker(QWidget *parent)
-    : QWidget(parent), currentIndex(-1)
+bool AccentPicker::isVisible() const
 {
+    return popup->isVisible();
+}
 
-    setWindowFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
-    setAttribute(Qt::WA_TranslucentBackground);
-    setAttribute(Qt::WA_ShowWithoutActivating);
+qint64 AccentPicker::memoryUsage() const
+{
+    return popup->memoryUsage();
+}
 
-    layout = new QHBoxLayout(this);
-    layout->setContentsMargins(8, 8, 8, 8);
-    layout->setSpacing(6);
+void AccentPicker::trimMemory()
+{
+    if (isVisible()) {
+        return;
+    }
 
-    setStyleSheet(
-        "QWidget {"
-        "    background-color: rgba(44, 44, 44, 240);"
-        "    border: 1px solid #555555;"
-        "    border-radius: 8px;"
-        "}"
-    );
+    preparedChar = 0;
+    clearButtons();
+    popup->releaseResources();
+    AccentMap::clearCache();
+    MemoryReport::trimHeap();
 }
 
-void AccentPicker::keyEvent(bool isPressed, const QString &baseChar)
+void AccentPicker::keyEvent(bool isPressed, char32_t baseChar)
 {
     if(isPressed) {
+        triggered = false;
         showAccents(baseChar);
-    } else {
+    } else if (!searching) {
         handleAccentSelected(currentIndex);
     }
 }
 
-void AccentPicker::showAccents(const QString &baseChar)
+void AccentPicker::trigger(char32_t baseChar)
+{
+    triggered = true;
+    showAccents(baseChar);
+}
+
+void AccentPicker::prepare()
+{
+    if (prepared) {
+        return;
+    }
+    prepared = true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Candidates of the plain letters under the selected sets
+    const LanguageMask languages = AccentMap::selectedLanguages();
+    QStringList common;
+    for (char32_t c = U'a'; c <= U'z'; ++c) {
+        common += AccentMap::getAccents(c, languages);
+        common += AccentMap::getAccents(QChar::toUpper(c), languages);
+    }
+    popup->realize(common);
+
+    qCDebug(lcLatency) << "popup prepared in" << timer.nsecsElapsed() / 1000 << "us";
+}
+
+void AccentPicker::prepareAccents(char32_t baseChar)
 {
+    preparedChar = 0;
+
+    if (baseChar == 0 || isVisible()) {
+        return;
+    }
+
+    // The answer usually arrives before the trigger; if not, the popup
+    // is shown at the best known place and moved when it does
+    caretLocator.request();
+
+    const LanguageMask languages = AccentMap::selectedLanguages();
+
+    // Already in the case of baseChar
+    accents = AccentMap::getAccents(baseChar, languages);
+    currentIndex = -1;
+
+    if (!accents.isEmpty()) {
+        popup->setAccents(accents);
+        popup->move(popupPosition());
+    }
+
+    preparedChar = baseChar;
+}
+
+void AccentPicker::discardAccents()
+{
+    // The popup content is simply overwritten by the next preparation
+    preparedChar = 0;
+    clearButtons();
+}
+
+void AccentPicker::showAccents(char32_t baseChar)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    prepare();
+
     if(isVisible()) {
         hide();
     }
 
-    if (baseChar.isEmpty()) return;
+    if (baseChar == 0) return;
 
-    const auto character = baseChar[0];
-    const auto languages = appConfig->get<ConfigKey::SelectedCharacterSets>();
-
-    QStringList accents = AccentMap::getAccents(character, languages);
+    // Skips the lookup and layout when the held key was prepared already
+    const bool speculative = preparedChar == baseChar;
+    if (!speculative) {
+        prepareAccents(baseChar);
+    }
+    preparedChar = 0;
 
     if (accents.isEmpty()) return;
 
-    auto getEffectiveLetter = [character](const QString& letter) {
-        return character.isUpper() ? letter.toUpper():letter;
-    };
+    idleTimer.stop();
+    popup->show();
 
-    clearButtons();
+    emit visibleChanged(true);
+    handleButtonHover(0);
+
+    qCDebug(lcLatency) << (showCount++ == 0 ? "first popup" : "popup") << "shown in"
+                       << timer.nsecsElapsed() / 1000 << "us" << (speculative ? "(prepared)" : "");
+}
+
+QPoint AccentPicker::popupPosition() const
+{
+    const QSize size = popup->size();
 
-    // Create buttons for each accent
-    for (int i = 0; i < accents.size(); ++i) {
-        AccentButton *button = new AccentButton(getEffectiveLetter(accents[i]), i, this);
-        layout->addWidget(button);
-        buttons.append(button);
+    if (const auto caret = caretLocator.cached()) {
+        // AT-SPI reports native pixels
+        const qreal ratio = qApp->devicePixelRatio();
+        const QRect logical(caret->topLeft() / ratio, caret->size() / ratio);
+
+        if (QScreen *screen = QGuiApplication::screenAt(logical.center())) {
+            return placeNear(logical, screen->availableGeometry(), size);
+        }
     }
 
-    adjustSize();
+    // Without a caret, the screen the user is looking at is the one with the pointer
+    QScreen *screen = QGuiApplication::screenAt(QCursor::pos());
+    if (!screen) {
+        screen = QApplication::primaryScreen();
+    }
 
-    QRect screenGeometry = QApplication::primaryScreen()->geometry();
+    QRect screenGeometry = screen->geometry();
+    const int width = size.width();
 
-    int x = screenGeometry.x() + (screenGeometry.width() - this->width()) / 2;
+    int x = screenGeometry.x() + (screenGeometry.width() - width) / 2;
     int y = screenGeometry.y() + 20;
 
     // Adjust if off-screen
     if (x < screenGeometry.left()) x = screenGeometry.left();
-    if (x + width() > screenGeometry.right()) x = screenGeometry.right() - width();
+    if (x + width > screenGeometry.right()) x = screenGeometry.right() - width;
     if (y < screenGeometry.top()) y =  screenGeometry.top() + 20;
 
-    move(x, y);
-    show();
-    activateWindow();
-    setFocus();
+    return QPoint(x, y);
+}
 
-    emit visibleChanged(true);
-    handleButtonHover(0);
+QPoint AccentPicker::placeNear(const QRect &caret, const QRect &screen, const QSize &size)
+{
+    int x = caret.center().x() - size.width() / 2;
+    int y = caret.bottom() + CaretGap;
+
+    // Above the caret when there is no room below
+    if (y + size.height() > screen.bottom()) {
+        y = caret.top() - CaretGap - size.height();
+    }
+
+    x = qBound(screen.left(), x, qMax(screen.left(), screen.right() - size.width()));
+    y = qBound(screen.top(), y, qMax(screen.top(), screen.bottom() - size.height()));
+
+    return QPoint(x, y);
+}
+
+void AccentPicker::caretFound()
+{
+    if (!accents.isEmpty()) {
+        popup->move(popupPosition());
+    }
 }
 
 void AccentPicker::hide()
 {
+    const bool wasVisible = popup->isVisible();
+
+    preparedChar = 0;
     clearButtons();
-    QWidget::hide();
+    popup->hide();
+
+    if (appConfig->get<ConfigKey::LowFootprint>()) {
+        idleTimer.start();
+    }
+
+    if (wasVisible) {
+        emit visibleChanged(false);
+    }
 }
 
 void AccentPicker::clearButtons()
 {
-    for (AccentButton *button : std::as_const(buttons)) {
-        layout->removeWidget(button);
-        button->deleteLater();
-    }
-    buttons.clear();
+    accents.clear();
+    baseAccents.clear();
+    query.clear();
+    searching = false;
     currentIndex = -1;
 }
 
 void AccentPicker::handleAccentSelected(int index)
 {
-    if (index >= 0 && index < buttons.size()) {
-        emit accentSelected(buttons[index]->getText());
+    if (index >= 0 && index < accents.size()) {
+        emit accentSelected(accents[index], !triggered);
         hide();
     }
 }
 
 void AccentPicker::handleButtonHover(int index)
 {
-    if (currentIndex >= 0 && currentIndex < buttons.size()) {
-        buttons[currentIndex]->setHighlighted(false);
-    }
-
     currentIndex = index;
-    if (currentIndex >= 0 && currentIndex < buttons.size()) {
-        buttons[currentIndex]->setHighlighted(true);
-    }
+    popup->setCurrentIndex(index);
 }
 
 void AccentPicker::goToNextButton()
 {
-    if (buttons.isEmpty()) {
+    if (accents.isEmpty()) {
         return;
     }
 
-    auto buttonsSize = buttons.size() - 1;
+    auto buttonsSize = accents.size() - 1;
 
     if (currentIndex < buttonsSize) {
         handleButtonHover(currentIndex + 1);
@@ -172,41 +305,113 @@ void AccentPicker::goToNextButton()
     }
 }
 
+void AccentPicker::goToRow(int delta)
+{
+    const int count = static_cast<int>(accents.size());
+    const int columns = AccentStripRenderer::columnsFor(count);
+    if (count == 0 || columns == 0) {
+        return;
+    }
+
+    const int column = qMax(currentIndex, 0) % columns;
+    int index = qMax(currentIndex, 0) + delta * columns;
+
+    // Wraps around within the column
+    if (index >= count) {
+        index = column;
+    } else if (index < 0) {
+        index = column + (count - 1 - column) / columns * columns;
+    }
+
+    handleButtonHover(index);
+}
+
 void AccentPicker::goToPreviousButton()
 {
-    if (buttons.isEmpty()) {
+    if (accents.isEmpty()) {
         return;
     }
 
     if (currentIndex > 0) {
         handleButtonHover(currentIndex - 1);
     } else {
-        handleButtonHover(buttons.size() - 1);
+        handleButtonHover(accents.size() - 1);
     }
 }
 
+bool AccentPicker::searchKey(int key)
+{
+    if (!searching) {
+        if (key != Qt::Key_Slash || !isVisible()) {
+            return false;
+        }
+
+        // Releasing the held base key no longer picks a candidate
+        searching = true;
+        baseAccents = accents;
+        query.clear();
+        updateSearch();
+        return true;
+    }
+
+    if (key >= Qt::Key_A && key <= Qt::Key_Z) {
+        query += QChar(u'a' + key - Qt::Key_A);
+    } else if (key == Qt::Key_Space) {
+        if (!query.isEmpty() && !query.endsWith(u' ')) {
+            query += u' ';
+        }
+    } else if (key == Qt::Key_Backspace) {
+        query.chop(1);
+    } else if (key == Qt::Key_Escape) {
+        // Back to the candidates of the base key; a second Escape closes
+        searching = false;
+        query.clear();
+        accents = baseAccents;
+        popup->setAccents(accents);
+        popup->move(popupPosition());
+        handleButtonHover(0);
+        return true;
+    } else {
+        return key == Qt::Key_Slash;
+    }
 
-void AccentPicker::keyPressEvent(QKeyEvent *event)
+    updateSearch();
+    return true;
+}
+
+void AccentPicker::updateSearch()
 {
-    if (buttons.isEmpty()) {
-        QWidget::keyPressEvent(event);
+    QElapsedTimer timer;
+    timer.start();
+
+    accents = query.trimmed().isEmpty() ? baseAccents : AccentSearch::search(query);
+    qCDebug(lcLatency) << "search" << query << "took" << timer.nsecsElapsed() / 1000 << "us";
+
+    popup->setAccents(accents, QStringLiteral("/") + query);
+    popup->move(popupPosition());
+    handleButtonHover(accents.isEmpty() ? -1 : 0);
+}
+
+void AccentPicker::navigate(int key)
+{
+    // Letters type the query instead of picking a label while searching
+    if (searchKey(key) || accents.isEmpty()) {
         return;
     }
 
-    auto key = event->key();
-
     if (key == Qt::Key_Right || key == Qt::Key_Space) {
         goToNextButton();
-        return;
     } else if (key == Qt::Key_Left) {
         goToPreviousButton();
-        return;
+    } else if (key == Qt::Key_Down) {
+        goToRow(1);
+    } else if (key == Qt::Key_Up) {
+        goToRow(-1);
+    } else if (key == Qt::Key_Return) {
+        handleAccentSelected(currentIndex);
+    } else if (key == Qt::Key_Escape) {
+        hide();
+    } else {
+        handleAccentSelected(AccentStripRenderer::indexForKey(key));
     }
-
-    QWidget::keyPressEvent(event);
-}
-
-void AccentPicker::hideEvent(QHideEvent *)
-{
-    emit visibleChanged(false);
 }
@@ -3,67 +3,92 @@
 #ifndef ACCENTPICKER_H
 #define ACCENTPICKER_H
 
-#include <QWidget>
-#include <QLabel>
-#include <QHBoxLayout>
-#include <QList>
-#include <QMouseEvent>
+#include <QObject>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QTimer>
 
-class AccentButton : public QLabel
+#include "gui/accentpopup.h"
+#include "platform/x11/caretlocator.h"
+
+Q_DECLARE_LOGGING_CATEGORY(lcLatency)
+
+/*
+ * Owns the candidates and the selection of the accent popup and drives
+ * an AccentPopup that displays them. The popup backend is picked by the
+ * popupBackend setting.
+ */
+class AccentPicker : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit AccentButton(const QString &text, int index, QWidget *parent = nullptr);
-
-    void setHighlighted(bool highlighted);
-    int getIndex() const
-    {
-        return index;
-    }
-    QString getText() const
-    {
-        return text();
-    }
+    explicit AccentPicker(QObject *parent = nullptr);
 
-private:
-    int index;
-    bool highlighted;
-    void updateStyle();
-};
+    // Takes ownership of popup; lets a benchmark drive a given backend
+    explicit AccentPicker(AccentPopup *popup, QObject *parent = nullptr);
 
-class AccentPicker : public QWidget
-{
-    Q_OBJECT
+    bool isVisible() const;
 
-public:
-    explicit AccentPicker(QWidget *parent = nullptr);
+    // Bytes held by the popup for drawing
+    qint64 memoryUsage() const;
 
 public slots:
-    void keyEvent(bool isPressed, const QString &baseChar);
-    void showAccents(const QString &baseChar);
+    void keyEvent(bool isPressed, char32_t baseChar);
+    void showAccents(char32_t baseChar);
+    // Shows the candidates of baseChar without a typed key to replace
+    void trigger(char32_t baseChar);
     void hide();
 
+    // Lays out the popup for baseChar without showing it, so that a
+    // following showAccents(baseChar) only has to map the window
+    void prepareAccents(char32_t baseChar);
+    void discardAccents();
+
+    // Handles a Qt::Key forwarded from the recorded key stream
+    void navigate(int key);
+
+    // Creates the native window and renders the common glyphs so the
+    // first popup of a session costs the same as any other
+    void prepare();
+
+    // Frees the popup resources and caches while hidden; called after a
+    // while without a popup in low footprint mode
+    void trimMemory();
+
 signals:
-    void accentSelected(const QString &accent);
+    // replaceTyped is false when the popup was opened by trigger()
+    void accentSelected(const QString &accent, bool replaceTyped);
     void visibleChanged(bool isVisible);
 
-protected:
-    void keyPressEvent(QKeyEvent *event) override;
-    void hideEvent(QHideEvent *event) override;
-
 private slots:
     void handleAccentSelected(int index);
     void handleButtonHover(int index);
+    void caretFound();
 
 private:
     void clearButtons();
+    QPoint popupPosition() const;
+    static QPoint placeNear(const QRect &caret, const QRect &screen, const QSize &size);
     void goToNextButton();
     void goToPreviousButton();
+    void goToRow(int delta);
+    bool searchKey(int key);
+    void updateSearch();
 
-    QHBoxLayout *layout;
-    QList<AccentButton*> buttons;
+    AccentPopup *popup;
+    CaretLocator caretLocator;
+    QStringList accents;
+    // Candidates of the base key while a search replaces them
+    QStringList baseAccents;
+    QString query;
+    bool searching;
+    bool triggered;
     int currentIndex;
+    bool prepared;
+    int showCount;
+    char32_t preparedChar;
+    QTimer idleTimer;
 };
 
 #endif // ACCENTPICKER_H
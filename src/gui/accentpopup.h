@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ACCENTPOPUP_H
+#define ACCENTPOPUP_H
+
+#include <QObject>
+#include <QPoint>
+#include <QSize>
+#include <QStringList>
+
+/*
+ * Surface that displays the candidate row for AccentPicker. The picker
+ * owns the candidates and the selection; a popup only lays them out,
+ * draws them and reports pointer input. Geometry is in logical pixels.
+ */
+class AccentPopup : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AccentPopup(QObject *parent = nullptr)
+        : QObject(parent)
+    {}
+
+    // Creates the native window and renders the given glyphs ahead of the
+    // first show
+    virtual void realize(const QStringList &accents) = 0;
+
+    // header is a line of text shown above the candidates, if not empty
+    virtual void setAccents(const QStringList &accents, const QString &header = QString()) = 0;
+    virtual void setCurrentIndex(int index) = 0;
+    virtual QSize size() const = 0;
+
+    virtual void move(const QPoint &pos) = 0;
+    virtual void show() = 0;
+    virtual void hide() = 0;
+    virtual bool isVisible() const = 0;
+
+    // Bytes held for drawing, e.g. glyph atlases and images
+    virtual qint64 memoryUsage() const = 0;
+    // Frees what memoryUsage() counts while hidden; it is rebuilt on demand
+    virtual void releaseResources() = 0;
+
+signals:
+    void hovered(int index);
+    void clicked(int index);
+};
+
+#endif // ACCENTPOPUP_H
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/accentstrip.h"
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+
+AccentStrip::AccentStrip(QWidget *parent)
+    : QWidget(parent), current(-1)
+{
+    setMouseTracking(true);
+    setCursor(Qt::PointingHandCursor);
+
+    connect(&renderer, &AccentStripRenderer::invalidated, this, [this]() {
+        updateGeometry();
+        adjustSize();
+        update();
+    });
+}
+
+void AccentStrip::setAccents(const QStringList &accents, const QString &header)
+{
+    renderer.setAccents(accents, devicePixelRatioF(), header);
+    current = -1;
+
+    updateGeometry();
+    update();
+}
+
+void AccentStrip::clear()
+{
+    renderer.clear();
+    current = -1;
+}
+
+void AccentStrip::setCurrentIndex(int index)
+{
+    current = index;
+    update(renderer.setCurrentIndex(index));
+}
+
+QSize AccentStrip::sizeHint() const
+{
+    return renderer.size();
+}
+
+void AccentStrip::warm(const QStringList &accents)
+{
+    renderer.warm(accents, devicePixelRatioF());
+}
+
+qint64 AccentStrip::memoryUsage() const
+{
+    return renderer.memoryUsage();
+}
+
+void AccentStrip::releaseResources()
+{
+    renderer.releaseResources();
+}
+
+void AccentStrip::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    renderer.paint(painter, event->rect(), devicePixelRatioF());
+}
+
+void AccentStrip::mouseMoveEvent(QMouseEvent *event)
+{
+    const int index = renderer.cellAt(event->position().toPoint());
+    if (index >= 0 && index != current) {
+        emit hovered(index);
+    }
+
+    QWidget::mouseMoveEvent(event);
+}
+
+void AccentStrip::mousePressEvent(QMouseEvent *event)
+{
+    const int index = renderer.cellAt(event->position().toPoint());
+    if (event->button() == Qt::LeftButton && index >= 0) {
+        emit clicked(index);
+        return;
+    }
+
+    QWidget::mousePressEvent(event);
+}
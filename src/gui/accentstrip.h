@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ACCENTSTRIP_H
+#define ACCENTSTRIP_H
+
+#include <QStringList>
+#include <QWidget>
+
+#include "gui/accentstriprenderer.h"
+
+/*
+ * Row of accent candidates painted by a single widget. Moving the
+ * highlight only repaints the two cells whose state changed.
+ */
+class AccentStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AccentStrip(QWidget *parent = nullptr);
+
+    void setAccents(const QStringList &accents, const QString &header = QString());
+    void clear();
+    void setCurrentIndex(int index);
+
+    QSize sizeHint() const override;
+
+    // Renders the glyphs into the atlas of the current screen ahead of use
+    void warm(const QStringList &accents);
+
+    qint64 memoryUsage() const;
+    void releaseResources();
+
+signals:
+    void hovered(int index);
+    void clicked(int index);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    AccentStripRenderer renderer;
+    int current;
+};
+
+#endif // ACCENTSTRIP_H
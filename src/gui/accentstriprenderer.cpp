@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/accentstriprenderer.h"
+
+#include <QGuiApplication>
+#include <QPainter>
+#include <QScreen>
+#include <QtMath>
+
+#include <cmath>
+
+namespace
+{
+constexpr int Margin = 8;
+constexpr int Spacing = 6;
+constexpr int Padding = 8;
+constexpr int CellSize = 40;
+constexpr qreal FrameRadius = 8;
+constexpr qreal CellRadius = 6;
+constexpr int LabelInset = 3;
+constexpr int HeaderHeight = 20;
+
+// A single row up to this many candidates, about sqrt(n) columns beyond
+constexpr int MaxRowLength = 8;
+constexpr int MaxVisibleRows = 6;
+
+const QColor FrameColor(44, 44, 44, 240);
+const QColor BorderColor(0x55, 0x55, 0x55);
+const QColor CellColor(0x2C, 0x2C, 0x2C);
+const QColor HighlightColor(0x4A, 0x90, 0xE2);
+const QColor TextColor(0xCC, 0xCC, 0xCC);
+const QColor HighlightTextColor(0xFF, 0xFF, 0xFF);
+const QColor LabelColor(0x88, 0x88, 0x88);
+const QColor HeaderColor(0xCC, 0xCC, 0xCC);
+
+QFont candidateFont()
+{
+    QFont font;
+    font.setPixelSize(20);
+    font.setBold(true);
+    return font;
+}
+}
+
+AccentStripRenderer::AccentStripRenderer(QObject *parent)
+    : QObject(parent), font(candidateFont()), metrics(font), headerHeight(0), columns(0), rows(0),
+      visibleRows(0), firstRow(0), ratio(1), current(-1)
+{
+    labelFont.setPixelSize(9);
+    headerFont.setPixelSize(13);
+    header.setTextFormat(Qt::PlainText);
+
+    // Glyphs rendered for a screen that went away or changed its DPI are stale
+    auto watchScreen = [this](QScreen *screen) {
+        connect(screen, &QScreen::logicalDotsPerInchChanged, this, &AccentStripRenderer::invalidateAtlases);
+        connect(screen, &QScreen::physicalDotsPerInchChanged, this, &AccentStripRenderer::invalidateAtlases);
+    };
+
+    const auto screens = QGuiApplication::screens();
+    for (QScreen *screen : screens) {
+        watchScreen(screen);
+    }
+
+    connect(qGuiApp, &QGuiApplication::screenAdded, this, [this, watchScreen](QScreen *screen) {
+        watchScreen(screen);
+        invalidateAtlases();
+    });
+    connect(qGuiApp, &QGuiApplication::screenRemoved, this, &AccentStripRenderer::invalidateAtlases);
+}
+
+AccentStripRenderer::~AccentStripRenderer()
+{
+    qDeleteAll(atlases);
+}
+
+void AccentStripRenderer::setAccents(const QStringList &accents, qreal devicePixelRatio, const QString &header)
+{
+    this->accents = accents;
+    this->header.setText(header);
+    this->header.prepare(QTransform(), headerFont);
+    headerHeight = header.isEmpty() ? 0 : HeaderHeight;
+    ratio = devicePixelRatio;
+    current = -1;
+    firstRow = 0;
+
+    const qsizetype count = accents.size();
+    columns = columnsFor(count);
+    rows = columns ? static_cast<int>((count + columns - 1) / columns) : 0;
+    visibleRows = qMin(rows, MaxVisibleRows);
+
+    // Measured, not rendered; cells outside the visible rows never are
+    qreal textWidth = 0;
+    for (const QString &accent : accents) {
+        textWidth = qMax(textWidth, metrics.horizontalAdvance(accent));
+    }
+
+    cellSize = QSize(qMax(CellSize, qCeil(textWidth) + 2 * Padding),
+                     qMax(CellSize, qCeil(metrics.height()) + 2 * Padding));
+
+    const int headerWidth = headerHeight ? qCeil(this->header.size().width()) : 0;
+
+    if (count == 0) {
+        contentSize = QSize(2 * Margin + headerWidth, 2 * Margin + (headerHeight ? headerHeight : CellSize));
+        return;
+    }
+
+    contentSize = QSize(2 * Margin + qMax(headerWidth, columns * cellSize.width() + (columns - 1) * Spacing),
+                        2 * Margin + headerHeight + visibleRows * cellSize.height() + (visibleRows - 1) * Spacing);
+}
+
+void AccentStripRenderer::clear()
+{
+    accents.clear();
+    header.setText(QString());
+    headerHeight = 0;
+    current = -1;
+    firstRow = 0;
+}
+
+int AccentStripRenderer::columnsFor(qsizetype count)
+{
+    if (count <= MaxRowLength) {
+        return static_cast<int>(count);
+    }
+
+    return qMax(MaxRowLength, qCeil(std::sqrt(static_cast<double>(count))));
+}
+
+QString AccentStripRenderer::label(int index)
+{
+    if (index < 0 || index >= LabelCount) {
+        return QString();
+    }
+
+    if (index < 10) {
+        return QString(QChar(u'0' + (index + 1) % 10));
+    }
+
+    return QString(QChar(u'A' + index - 10));
+}
+
+int AccentStripRenderer::indexForKey(int key)
+{
+    if (key >= Qt::Key_1 && key <= Qt::Key_9) {
+        return key - Qt::Key_1;
+    }
+
+    if (key == Qt::Key_0) {
+        return 9;
+    }
+
+    if (key >= Qt::Key_A && key <= Qt::Key_Z) {
+        return 10 + key - Qt::Key_A;
+    }
+
+    return -1;
+}
+
+QRegion AccentStripRenderer::setCurrentIndex(int index)
+{
+    QRegion damaged;
+
+    if (index == current) {
+        return damaged;
+    }
+
+    damaged += cellRect(current);
+    current = index;
+
+    // Scrolls the window of rows to keep the selection in it
+    if (current >= 0 && columns > 0) {
+        const int row = current / columns;
+        const int previousFirst = firstRow;
+
+        if (row < firstRow) {
+            firstRow = row;
+        } else if (row >= firstRow + visibleRows) {
+            firstRow = row - visibleRows + 1;
+        }
+
+        if (firstRow != previousFirst) {
+            return QRegion(QRect(QPoint(0, 0), contentSize));
+        }
+    }
+
+    damaged += cellRect(current);
+    return damaged;
+}
+
+void AccentStripRenderer::paint(QPainter &painter, const QRect &exposed, qreal devicePixelRatio)
+{
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // A translucent surface clears the update region, so the frame is
+    // always redrawn; the painter clips it to the damaged cells
+    painter.setPen(BorderColor);
+    painter.setBrush(FrameColor);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), contentSize).adjusted(0.5, 0.5, -0.5, -0.5),
+                            FrameRadius, FrameRadius);
+
+    if (headerHeight && exposed.top() < Margin + headerHeight) {
+        painter.setFont(headerFont);
+        painter.setPen(HeaderColor);
+        painter.drawStaticText(QPointF(Margin, Margin + (headerHeight - header.size().height()) / 2), header);
+    }
+
+    GlyphAtlas &glyphs = atlas(devicePixelRatio);
+
+    const int first = firstRow * columns;
+    const int last = static_cast<int>(qMin<qsizetype>(accents.size(), (firstRow + visibleRows) * columns));
+
+    painter.setFont(labelFont);
+
+    for (int i = first; i < last; ++i) {
+        const QRect cell = cellRect(i);
+        if (!exposed.intersects(cell)) {
+            continue;
+        }
+
+        const bool highlighted = i == current;
+        const GlyphAtlas::Entry background = glyphs.cell(cell.size(), highlighted);
+        const GlyphAtlas::Entry text = glyphs.glyph(accents[i], highlighted);
+
+        painter.drawPixmap(QRectF(cell), glyphs.pixmap(), QRectF(background.source));
+
+        const QPointF textPos(cell.x() + (cell.width() - text.size.width()) / 2.0,
+                              cell.y() + (cell.height() - text.size.height()) / 2.0);
+        painter.drawPixmap(QRectF(textPos, QSizeF(text.size)), glyphs.pixmap(), QRectF(text.source));
+
+        if (i < LabelCount) {
+            painter.setPen(highlighted ? HighlightTextColor : LabelColor);
+            painter.drawStaticText(cell.topLeft() + QPoint(LabelInset, LabelInset / 2), labelText(i));
+        }
+    }
+}
+
+int AccentStripRenderer::cellAt(const QPoint &pos) const
+{
+    if (columns == 0) {
+        return -1;
+    }
+
+    const QPoint local = pos - QPoint(Margin, Margin + headerHeight);
+    const int stepX = cellSize.width() + Spacing;
+    const int stepY = cellSize.height() + Spacing;
+
+    if (local.x() < 0 || local.y() < 0 || local.x() % stepX >= cellSize.width()
+            || local.y() % stepY >= cellSize.height()) {
+        return -1;
+    }
+
+    const int column = local.x() / stepX;
+    const int row = local.y() / stepY;
+    if (column >= columns || row >= visibleRows) {
+        return -1;
+    }
+
+    const int index = (firstRow + row) * columns + column;
+    return index < accents.size() ? index : -1;
+}
+
+void AccentStripRenderer::warm(const QStringList &accents, qreal devicePixelRatio)
+{
+    atlas(devicePixelRatio).warm(accents);
+}
+
+qint64 AccentStripRenderer::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const GlyphAtlas *glyphs : atlases) {
+        const QPixmap &pixmap = glyphs->pixmap();
+        bytes += static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+
+    return bytes;
+}
+
+void AccentStripRenderer::releaseResources()
+{
+    qDeleteAll(atlases);
+    atlases.clear();
+}
+
+void AccentStripRenderer::invalidateAtlases()
+{
+    qDeleteAll(atlases);
+    atlases.clear();
+
+    if (!accents.isEmpty() || headerHeight) {
+        const int index = current;
+        const int row = firstRow;
+        setAccents(QStringList(accents), ratio, header.text());
+        current = index;
+        firstRow = row;
+    }
+
+    emit invalidated();
+}
+
+GlyphAtlas& AccentStripRenderer::atlas(qreal devicePixelRatio)
+{
+    GlyphAtlas *&glyphs = atlases[devicePixelRatio];
+    if (!glyphs) {
+        glyphs = new GlyphAtlas(font, devicePixelRatio,
+                                {TextColor, CellColor, CellRadius},
+                                {HighlightTextColor, HighlightColor, CellRadius});
+    }
+
+    return *glyphs;
+}
+
+QRect AccentStripRenderer::cellRect(int index) const
+{
+    if (index < 0 || index >= accents.size() || columns == 0) {
+        return QRect();
+    }
+
+    const int row = index / columns - firstRow;
+    if (row < 0 || row >= visibleRows) {
+        return QRect();
+    }
+
+    const int column = index % columns;
+    return QRect(Margin + column * (cellSize.width() + Spacing),
+                 Margin + headerHeight + row * (cellSize.height() + Spacing),
+                 cellSize.width(), cellSize.height());
+}
+
+const QStaticText& AccentStripRenderer::labelText(int index)
+{
+    if (labels.isEmpty()) {
+        for (int i = 0; i < LabelCount; ++i) {
+            QStaticText text(label(i));
+            text.setTextFormat(Qt::PlainText);
+            text.prepare(QTransform(), labelFont);
+            labels.append(text);
+        }
+    }
+
+    return labels[index];
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ACCENTSTRIPRENDERER_H
+#define ACCENTSTRIPRENDERER_H
+
+#include <QFont>
+#include <QFontMetricsF>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QRegion>
+#include <QStaticText>
+#include <QStringList>
+
+#include "gui/glyphatlas.h"
+
+class QPainter;
+
+/*
+ * Layout and painting of the candidate grid, independent of the surface
+ * it is drawn on. Candidates wrap into rows of about sqrt(n) cells of one
+ * size; only a window of rows is shown and only the cells in it are ever
+ * rendered, scrolling as the selection moves. Cells are blitted from a
+ * glyph atlas kept per device pixel ratio. An optional header line above
+ * the grid shows e.g. the search query.
+ */
+class AccentStripRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AccentStripRenderer(QObject *parent = nullptr);
+    ~AccentStripRenderer();
+
+    void setAccents(const QStringList &accents, qreal devicePixelRatio, const QString &header = QString());
+    void clear();
+
+    // Number of columns of the grid for count candidates
+    static int columnsFor(qsizetype count);
+
+    // Candidates with an index below LabelCount get a key label: 1-9, 0, A-Z
+    static constexpr int LabelCount = 36;
+    static QString label(int index);
+    // Index of the candidate labelled with the Qt::Key key, or -1
+    static int indexForKey(int key);
+
+    // Returns the area that has to be repainted
+    QRegion setCurrentIndex(int index);
+
+    QSize size() const
+    {
+        return contentSize;
+    }
+
+    void paint(QPainter &painter, const QRect &exposed, qreal devicePixelRatio);
+    int cellAt(const QPoint &pos) const;
+
+    // Renders the glyphs into the atlas for devicePixelRatio ahead of use
+    void warm(const QStringList &accents, qreal devicePixelRatio);
+
+    // Bytes of pixel data held by the atlases
+    qint64 memoryUsage() const;
+    // Drops the atlases; they are rendered again on the next paint
+    void releaseResources();
+
+signals:
+    // The atlases were rebuilt after a screen change and the layout may
+    // have changed; resize and repaint
+    void invalidated();
+
+private:
+    void invalidateAtlases();
+    GlyphAtlas& atlas(qreal devicePixelRatio);
+    QRect cellRect(int index) const;
+    const QStaticText& labelText(int index);
+
+    QFont font;
+    QFontMetricsF metrics;
+    QFont labelFont;
+    QFont headerFont;
+    QStringList accents;
+    QStaticText header;
+    int headerHeight;
+    // One atlas per device pixel ratio the strip was drawn at
+    QHash<qreal, GlyphAtlas*> atlases;
+    QList<QStaticText> labels;
+    QSize cellSize;
+    QSize contentSize;
+    int columns;
+    int rows;
+    int visibleRows;
+    int firstRow;
+    qreal ratio;
+    int current;
+};
+
+#endif // ACCENTSTRIPRENDERER_H
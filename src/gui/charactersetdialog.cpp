@@ -68,8 +68,22 @@ void CharacterSetDialog::setupUI()
     const auto languageSets = AccentMap::getAllLanguages();
     auto isAllSelected = appConfig->get<ConfigKey::SelectedAllCharacterSets>();
 
+    QGroupBox *optionalGroup = new QGroupBox("Additional sets");
+    optionalGroup->setFont(groupFont);
+
+    QGridLayout *optionalLayout = new QGridLayout(optionalGroup);
+    optionalLayout->setSpacing(10);
+
     int row = 0, col = 0;
+    int optionalCol = 0;
     for (const auto &lang : languageSets) {
+        if (AccentMap::isOptional(lang.language)) {
+            QCheckBox *cb = createCheckBox(lang, false);
+            optionalCheckBoxes[lang.code] = cb;
+            optionalLayout->addWidget(cb, 0, optionalCol++);
+            continue;
+        }
+
         QCheckBox *cb = createCheckBox(lang, isAllSelected);
         if(lang.language != Language::ALL) {
             languageCheckBoxes[lang.code] = cb;
@@ -84,6 +98,7 @@ void CharacterSetDialog::setupUI()
     }
 
     mainLayout->addWidget(languageGroup);
+    mainLayout->addWidget(optionalGroup);
 
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
 
@@ -147,7 +162,7 @@ QCheckBox* CharacterSetDialog::createCheckBox(const LanguageInfo &langInfo, bool
                 setAllCheckBoxes(true);
             }
         });
-    } else {
+    } else if (!AccentMap::isOptional(langInfo.language)) {
         connect(checkBox, &QCheckBox::checkStateChanged,this, &CharacterSetDialog::updateAllCheckState);
     }
 
@@ -212,12 +227,17 @@ void CharacterSetDialog::setAllCheckBoxes(bool value)
 
 void CharacterSetDialog::loadSettings()
 {
+    const QStringList sets = appConfig->get<ConfigKey::SelectedCharacterSets>();
+    for (auto it = optionalCheckBoxes.constBegin(); it != optionalCheckBoxes.constEnd(); ++it) {
+        it.value()->setChecked(sets.contains(it.key()));
+    }
+
     auto isAllSelected = appConfig->get<ConfigKey::SelectedAllCharacterSets>();
     if(isAllSelected) {
         return;
     }
 
-    QVariant savedSets = appConfig->get<ConfigKey::SelectedCharacterSets>();
+    QVariant savedSets = sets;
     if (savedSets.isValid()) {
         setSelectedSets(savedSets.toStringList());
     } else {
@@ -234,14 +254,15 @@ void CharacterSetDialog::saveSettings()
         isAllSelected = checkAllBox->checkState() == Qt::Checked;
     }
 
-    appConfig->set<ConfigKey::SelectedAllCharacterSets>(isAllSelected);
-
-    if(isAllSelected) {
-        return;
+    QStringList selected = isAllSelected ? QStringList() : getSelectedSets();
+    for (auto it = optionalCheckBoxes.constBegin(); it != optionalCheckBoxes.constEnd(); ++it) {
+        if (it.value()->isChecked()) {
+            selected.append(it.key());
+        }
     }
 
-    const auto selected = getSelectedSets();
     appConfig->set<ConfigKey::SelectedCharacterSets>(selected);
+    appConfig->set<ConfigKey::SelectedAllCharacterSets>(isAllSelected);
 }
 
 void CharacterSetDialog::accept()
@@ -31,6 +31,8 @@ private:
 
     QCheckBox *checkAllBox;
     QMap<QString, QCheckBox*> languageCheckBoxes;
+    // Unicode, Compose and Custom, which "All Languages" leaves out
+    QMap<QString, QCheckBox*> optionalCheckBoxes;
 
     QStringList getSelectedSets() const;
     void setSelectedSets(const QStringList &sets);
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/controlcommands.h"
+#include "gui/accentpicker.h"
+#include "gui/trayicon.h"
+#include "core/accentmap.h"
+#include "core/accentsearch.h"
+#include "core/composeaccents.h"
+#include "core/customaccents.h"
+#include "core/keymonitor.h"
+#include "core/memoryreport.h"
+#include "config/appconfig.h"
+#include "config/configkeys.h"
+
+#include <QRegularExpression>
+
+ControlCommands::ControlCommands(AccentPicker *picker, KeyMonitor *monitor, TrayIcon *tray, QObject *parent)
+    : QObject(parent), picker(picker), monitor(monitor), tray(tray), commandCount(0), shownCount(0),
+      insertedCount(0), paused(false)
+{
+    uptime.start();
+
+    connect(picker, &AccentPicker::visibleChanged, this, [this](bool isVisible) {
+        if (isVisible) {
+            ++shownCount;
+        }
+    });
+    connect(picker, &AccentPicker::accentSelected, this, [this]() {
+        ++insertedCount;
+    });
+
+    // Turning the monitor on or off through the settings ends a pause
+    appConfig->onChanged<ConfigKey::Active>(this, [this](bool) {
+        paused = false;
+    });
+}
+
+QByteArray ControlCommands::execute(const QByteArray &line)
+{
+    ++commandCount;
+
+    const qsizetype space = line.indexOf(' ');
+    const QByteArray command = space < 0 ? line : line.left(space);
+    const QByteArray argument = space < 0 ? QByteArray() : line.mid(space + 1);
+
+    if (command == "ping") {
+        return "ok pong";
+    } else if (command == "show") {
+        tray->showWindow();
+    } else if (command == "toggle") {
+        appConfig->set<ConfigKey::Active>(!appConfig->get<ConfigKey::Active>());
+    } else if (command == "pause") {
+        if (!paused && monitor->isRunning()) {
+            picker->hide();
+            monitor->stop();
+            paused = true;
+        }
+    } else if (command == "resume") {
+        if (paused) {
+            paused = false;
+            monitor->start();
+        }
+    } else if (command == "reload") {
+        appConfig->reload();
+        composeAccents->load();
+        customAccents->load();
+        AccentMap::clearCache();
+    } else if (command == "stats") {
+        return stats();
+    } else if (command == "memory") {
+        return memory();
+    } else if (command == "trim") {
+        if (picker->isVisible()) {
+            return "error popup is shown";
+        }
+        picker->trimMemory();
+    } else if (command == "trigger") {
+        return trigger(argument);
+    } else if (command == "insert") {
+        if (argument.isEmpty()) {
+            return "error insert needs a text";
+        }
+        monitor->pasteText(QString::fromUtf8(argument));
+    } else if (command == "set-sets") {
+        return setSets(argument);
+    } else {
+        return "error unknown command " + command;
+    }
+
+    return "ok";
+}
+
+QByteArray ControlCommands::trigger(const QByteArray &argument)
+{
+    const QList<uint> codePoints = QString::fromUtf8(argument).toUcs4();
+    if (codePoints.size() != 1) {
+        return "error trigger needs one character";
+    }
+
+    // Keys in the popup arrive through the monitor, without it the
+    // keyboard grab would lock the user out
+    if (paused || !monitor->isRunning()) {
+        return "error not active";
+    }
+
+    picker->trigger(codePoints.first());
+
+    return picker->isVisible() ? QByteArray("ok") : "error no candidates for " + argument;
+}
+
+QByteArray ControlCommands::setSets(const QByteArray &argument)
+{
+    const QStringList codes = QString::fromUtf8(argument).toUpper().split(QRegularExpression(QStringLiteral("[ ,]+")),
+                              Qt::SkipEmptyParts);
+    if (codes.isEmpty()) {
+        return "error set-sets needs set codes";
+    }
+
+    for (const QString &code : codes) {
+        if (AccentMap::languageMask({code}) == 0) {
+            return "error unknown set " + code.toUtf8();
+        }
+    }
+
+    // "all" covers the languages; optional sets are named next to it
+    QStringList sets = codes;
+    const bool all = sets.removeAll(QStringLiteral("ALL")) > 0;
+
+    appConfig->set<ConfigKey::SelectedCharacterSets>(sets);
+    appConfig->set<ConfigKey::SelectedAllCharacterSets>(all);
+
+    return "ok";
+}
+
+QByteArray ControlCommands::stats() const
+{
+    const auto config = appConfig->snapshot();
+
+    return "ok uptime=" + QByteArray::number(uptime.elapsed() / 1000)
+           + " commands=" + QByteArray::number(commandCount)
+           + " shown=" + QByteArray::number(shownCount)
+           + " inserted=" + QByteArray::number(insertedCount)
+           + " active=" + (config->get<ConfigKey::Active>() ? "1" : "0")
+           + " paused=" + (paused ? "1" : "0")
+           + " sets=" + (config->get<ConfigKey::SelectedAllCharacterSets>()
+                         ? QByteArray("ALL") : config->get<ConfigKey::SelectedCharacterSets>().join(u',').toUtf8());
+}
+
+QByteArray ControlCommands::memory() const
+{
+    MemoryReport report;
+    report.add("popup", picker->memoryUsage());
+    report.add("accentcache", AccentMap::cacheMemoryUsage());
+    report.add("compose", composeAccents->memoryUsage());
+    report.add("custom", customAccents->memoryUsage());
+    // Read-only data of the binary, shared with other instances
+    report.add("tables", AccentMap::tableSize() + AccentSearch::indexSize());
+
+    return "ok " + report.toLine() + " window=" + (tray->hasWindow() ? "1" : "0");
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CONTROLCOMMANDS_H
+#define CONTROLCOMMANDS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+
+class AccentPicker;
+class KeyMonitor;
+class TrayIcon;
+
+/*
+ * Commands accepted on the instance socket, one per line:
+ *
+ *   ping, show, toggle, pause, resume, reload, stats, memory, trim,
+ *   trigger <character>, insert <text>, set-sets [all] [<code>...]
+ *
+ * The reply is "ok", "ok <details>" or "error <reason>". pause stops the
+ * key monitor until resume without changing the Active setting. memory
+ * replies with a MemoryReport line, trim frees what low footprint mode
+ * frees when idle.
+ */
+class ControlCommands : public QObject
+{
+    Q_OBJECT
+
+public:
+    ControlCommands(AccentPicker *picker, KeyMonitor *monitor, TrayIcon *tray, QObject *parent = nullptr);
+
+    QByteArray execute(const QByteArray &line);
+
+private:
+    QByteArray trigger(const QByteArray &argument);
+    QByteArray setSets(const QByteArray &argument);
+    QByteArray stats() const;
+    QByteArray memory() const;
+
+    AccentPicker *picker;
+    KeyMonitor *monitor;
+    TrayIcon *tray;
+
+    QElapsedTimer uptime;
+    quint64 commandCount;
+    quint64 shownCount;
+    quint64 insertedCount;
+    bool paused;
+};
+
+#endif // CONTROLCOMMANDS_H
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/glyphatlas.h"
+
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QtMath>
+
+namespace
+{
+constexpr int AtlasWidth = 512; // logical pixels
+constexpr int InitialHeight = 128;
+constexpr int Gap = 1; // keeps filtering from bleeding between entries
+}
+
+GlyphAtlas::GlyphAtlas(const QFont &font, qreal devicePixelRatio, const Style &normal, const Style &highlighted)
+    : font(font), ratio(devicePixelRatio), shelfHeight(0)
+{
+    styles[0] = normal;
+    styles[1] = highlighted;
+
+    grow(QSize(qCeil(AtlasWidth * ratio), qCeil(InitialHeight * ratio)));
+}
+
+GlyphAtlas::Entry GlyphAtlas::glyph(const QString &text, bool highlighted)
+{
+    auto it = glyphs[highlighted].constFind(text);
+    if (it != glyphs[highlighted].constEnd()) {
+        return *it;
+    }
+
+    const QFontMetricsF metrics(font);
+    const QSize size(qCeil(metrics.horizontalAdvance(text)), qCeil(metrics.height()));
+
+    Entry entry{allocate(size), size};
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setClipRect(entry.source);
+    painter.translate(entry.source.topLeft());
+    painter.scale(ratio, ratio);
+    painter.setFont(font);
+    painter.setPen(styles[highlighted].text);
+    painter.drawText(QRectF(QPointF(0, 0), size), Qt::AlignCenter, text);
+
+    glyphs[highlighted].insert(text, entry);
+    return entry;
+}
+
+GlyphAtlas::Entry GlyphAtlas::cell(const QSize &size, bool highlighted)
+{
+    const quint64 key = (static_cast<quint64>(size.width()) << 32) | static_cast<quint32>(size.height());
+
+    auto it = cells[highlighted].constFind(key);
+    if (it != cells[highlighted].constEnd()) {
+        return *it;
+    }
+
+    Entry entry{allocate(size), size};
+    const Style &style = styles[highlighted];
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(entry.source);
+    painter.translate(entry.source.topLeft());
+    painter.scale(ratio, ratio);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(style.background);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), size), style.radius, style.radius);
+
+    cells[highlighted].insert(key, entry);
+    return entry;
+}
+
+void GlyphAtlas::warm(const QStringList &texts)
+{
+    for (const QString &text : texts) {
+        glyph(text, false);
+        glyph(text, true);
+    }
+}
+
+QRect GlyphAtlas::allocate(const QSize &logicalSize)
+{
+    const QSize size(qCeil(logicalSize.width() * ratio), qCeil(logicalSize.height() * ratio));
+
+    if (shelf.x() + size.width() > atlas.width() && shelf.x() > 0) {
+        shelf = QPoint(0, shelf.y() + shelfHeight + Gap);
+        shelfHeight = 0;
+    }
+
+    if (shelf.y() + size.height() > atlas.height() || size.width() > atlas.width()) {
+        grow(QSize(qMax(atlas.width(), size.width()),
+                   qMax(atlas.height() * 2, shelf.y() + size.height())));
+    }
+
+    const QRect rect(shelf, size);
+
+    shelf.rx() += size.width() + Gap;
+    shelfHeight = qMax(shelfHeight, size.height());
+
+    return rect;
+}
+
+void GlyphAtlas::grow(const QSize &minimumSize)
+{
+    QPixmap grown(minimumSize);
+    grown.fill(Qt::transparent);
+
+    if (!atlas.isNull()) {
+        QPainter painter(&grown);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawPixmap(0, 0, atlas);
+    }
+
+    atlas = grown;
+}
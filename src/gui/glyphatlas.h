@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QPixmap>
+#include <QRect>
+#include <QStringList>
+
+/*
+ * Pre-rendered candidate glyphs and cell backgrounds for one device pixel
+ * ratio, packed into a single pixmap on shelves. Entries are rendered the
+ * first time they are asked for, so painting a popup whose glyphs were
+ * seen before is a handful of pixmap blits.
+ */
+class GlyphAtlas
+{
+public:
+    struct Entry {
+        QRect source; // in atlas pixels
+        QSize size;   // in logical pixels
+    };
+
+    struct Style {
+        QColor text;
+        QColor background;
+        qreal radius = 0;
+    };
+
+    GlyphAtlas(const QFont &font, qreal devicePixelRatio, const Style &normal, const Style &highlighted);
+
+    qreal devicePixelRatio() const
+    {
+        return ratio;
+    }
+    const QPixmap& pixmap() const
+    {
+        return atlas;
+    }
+
+    Entry glyph(const QString &text, bool highlighted);
+    Entry cell(const QSize &size, bool highlighted);
+
+    // Renders the glyphs ahead of their first popup
+    void warm(const QStringList &texts);
+
+private:
+    QRect allocate(const QSize &logicalSize);
+    void grow(const QSize &minimumSize);
+
+    QFont font;
+    qreal ratio;
+    Style styles[2];
+
+    QPixmap atlas;
+    QPoint shelf;
+    int shelfHeight;
+
+    QHash<QString, Entry> glyphs[2];
+    QHash<quint64, Entry> cells[2];
+};
+
+#endif // GLYPHATLAS_H
@@ -7,18 +7,18 @@
 #include <QDir>
 #include <QApplication>
 #include <QCloseEvent>
-#include <QSettings>
-#include <QSystemTrayIcon>
-#include <QMenu>
+#include <QHideEvent>
+#include <QFile>
 #include <QPushButton>
+#include <QScreen>
+#include <QTextStream>
 
 #include "charactersetdialog.h"
-#include "core/keymonitor.h"
 #include "config/appconfig.h"
 #include "config/configkeys.h"
 
-MainWindow::MainWindow(KeyMonitor* monitor, QWidget* parent)
-    : QMainWindow(parent), monitor(monitor)
+MainWindow::MainWindow(QWidget* parent)
+    : QMainWindow(parent)
 {
     QWidget* central = new QWidget(this);
     QVBoxLayout* layout = new QVBoxLayout(central);
@@ -26,29 +26,49 @@ MainWindow::MainWindow(KeyMonitor* monitor, QWidget* parent)
     auto activateCheck   = new QCheckBox("Activate "+ qApp->applicationDisplayName(), this);
     auto startHiddenCheck = new QCheckBox("Start hidden", this);
     auto autostartCheck   = new QCheckBox("Start with system", this);
+    auto lowFootprintCheck = new QCheckBox("Use less memory while idle", this);
 
     langSetConfigButton = new QPushButton("Config lang sets");
 
     layout->addWidget(activateCheck);
     layout->addWidget(startHiddenCheck);
     layout->addWidget(autostartCheck);
+    layout->addWidget(lowFootprintCheck);
     layout->addWidget(langSetConfigButton);
     setCentralWidget(central);
 
     activateCheck->setChecked(appConfig->get<ConfigKey::Active>());
     startHiddenCheck->setChecked(appConfig->get<ConfigKey::StartHidden>());
     autostartCheck->setChecked(appConfig->get<ConfigKey::AutoStart>());
+    lowFootprintCheck->setChecked(appConfig->get<ConfigKey::LowFootprint>());
 
     connect(startHiddenCheck, &QCheckBox::toggled,
     [](bool v) {
         appConfig->set<ConfigKey::StartHidden>(v);
     });
+    connect(lowFootprintCheck, &QCheckBox::toggled,
+    [](bool v) {
+        appConfig->set<ConfigKey::LowFootprint>(v);
+    });
     connect(activateCheck, &QCheckBox::toggled, this, &MainWindow::onMonitorToggled);
     connect(autostartCheck, &QCheckBox::toggled, this, &MainWindow::onAutoStartToggled);
     connect(langSetConfigButton, &QPushButton::clicked,this, &MainWindow::onConfigButtonClicked);
 
-    setupTrayIcon();
     setupWindow();
+
+    // Also follows changes made to the settings file while running
+    appConfig->onChanged<ConfigKey::Active>(activateCheck, [activateCheck](bool active) {
+        activateCheck->setChecked(active);
+    });
+    appConfig->onChanged<ConfigKey::StartHidden>(startHiddenCheck, [startHiddenCheck](bool startHidden) {
+        startHiddenCheck->setChecked(startHidden);
+    });
+    appConfig->onChanged<ConfigKey::AutoStart>(autostartCheck, [autostartCheck](bool autoStart) {
+        autostartCheck->setChecked(autoStart);
+    });
+    appConfig->onChanged<ConfigKey::LowFootprint>(lowFootprintCheck, [lowFootprintCheck](bool lowFootprint) {
+        lowFootprintCheck->setChecked(lowFootprint);
+    });
 }
 
 void MainWindow::onAutoStartToggled(bool value)
@@ -83,18 +103,16 @@ void MainWindow::onAutoStartToggled(bool value)
 
 void MainWindow::onMonitorToggled(bool active)
 {
-    if(active) {
-        monitor->start();
-    } else {
-        monitor->stop();
-    }
     appConfig->set<ConfigKey::Active>(active);
 }
 
 void MainWindow::onConfigButtonClicked(bool)
 {
-    CharacterSetDialog dialog(this);
-    dialog.exec();
+    // No nested event loop: the window may be deleted while the dialog
+    // is open when it is hidden in low footprint mode
+    auto *dialog = new CharacterSetDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->open();
 }
 
 
@@ -105,47 +123,19 @@ void MainWindow::setupWindow()
     move(QGuiApplication::primaryScreen()->availableGeometry().center() - rect().center());
 }
 
-void MainWindow::toggleVisible()
+void MainWindow::closeEvent(QCloseEvent* event)
 {
-    if (!isMinimized() && isVisible()) {
-        hide();
-    } else {
-        show();
-    }
+    event->ignore();
+    hide();
 }
 
-void MainWindow::setupTrayIcon()
+void MainWindow::hideEvent(QHideEvent* event)
 {
-    QSystemTrayIcon* tray = new QSystemTrayIcon(this);
-    tray->setIcon(QIcon(":/icons/accentpicker.png"));
-
-    QMenu* trayMenu = new QMenu(this);
-    QAction* showAction = trayMenu->addAction("Show");
-    QAction* activateAction = trayMenu->addAction("Activate");
-    activateAction->setCheckable(true);
-    activateAction->setChecked(appConfig->get<ConfigKey::Active>());
-    trayMenu->addSeparator();
-    QAction* quitAction = trayMenu->addAction("Quit");
-
-    tray->setContextMenu(trayMenu);
-    tray->show();
-
-    connect( tray, &QSystemTrayIcon::activated, [this](QSystemTrayIcon::ActivationReason reason) {
-        if(reason ==QSystemTrayIcon::Trigger ) {
-            toggleVisible();
-        }
-    });
-
-    connect(showAction, &QAction::triggered, this, &QWidget::show);
-    connect(activateAction, &QAction::toggled, this, &MainWindow::onMonitorToggled);
-    connect(quitAction, &QAction::triggered, []() {
-        qApp->quit();
-    });
-}
+    QMainWindow::hideEvent(event);
 
-void MainWindow::closeEvent(QCloseEvent* event)
-{
-    event->ignore();
-    hide();
+    // Minimizing hides too, but the window is still in use then
+    if (!event->spontaneous()) {
+        emit hidden();
+    }
 }
 
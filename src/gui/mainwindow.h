@@ -6,14 +6,16 @@
 #include <QMainWindow>
 
 class QCheckBox;
-class KeyMonitor;
 class QPushButton;
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 public:
-    explicit MainWindow(KeyMonitor* monitor, QWidget* parent = nullptr);
+    explicit MainWindow(QWidget* parent = nullptr);
+
+signals:
+    void hidden();
 
 protected slots:
     void onAutoStartToggled(bool value);
@@ -21,14 +23,12 @@ protected slots:
     void onConfigButtonClicked(bool);
 protected:
     void closeEvent(QCloseEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private:
-    KeyMonitor* monitor;
     QPushButton* langSetConfigButton;
 
     void setupWindow();
-    void setupTrayIcon();
-    void toggleVisible();
 };
 
 #endif //MAINWINDOW_H
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/trayicon.h"
+#include "gui/mainwindow.h"
+#include "config/appconfig.h"
+#include "config/configkeys.h"
+
+#include <QApplication>
+#include <QMenu>
+#include <QSystemTrayIcon>
+
+TrayIcon::TrayIcon(QObject *parent)
+    : QObject(parent), tray(new QSystemTrayIcon(this)), menu(std::make_unique<QMenu>())
+{
+    tray->setIcon(QIcon(":/icons/accentpicker.png"));
+
+    QAction* showAction = menu->addAction("Show");
+    activateAction = menu->addAction("Activate");
+    activateAction->setCheckable(true);
+    activateAction->setChecked(appConfig->get<ConfigKey::Active>());
+    menu->addSeparator();
+    QAction* quitAction = menu->addAction("Quit");
+
+    tray->setContextMenu(menu.get());
+    tray->show();
+
+    connect(tray, &QSystemTrayIcon::activated, this, [this](QSystemTrayIcon::ActivationReason reason) {
+        if (reason == QSystemTrayIcon::Trigger) {
+            toggleWindow();
+        }
+    });
+
+    connect(showAction, &QAction::triggered, this, &TrayIcon::showWindow);
+    connect(activateAction, &QAction::toggled, this, [](bool active) {
+        appConfig->set<ConfigKey::Active>(active);
+    });
+    connect(quitAction, &QAction::triggered, []() {
+        qApp->quit();
+    });
+
+    appConfig->onChanged<ConfigKey::Active>(this, [this](bool active) {
+        activateAction->setChecked(active);
+    });
+}
+
+TrayIcon::~TrayIcon() = default;
+
+void TrayIcon::showWindow()
+{
+    window().show();
+    window().raise();
+    window().activateWindow();
+}
+
+void TrayIcon::toggleWindow()
+{
+    if (mainWindow && !mainWindow->isMinimized() && mainWindow->isVisible()) {
+        mainWindow->hide();
+    } else {
+        showWindow();
+    }
+}
+
+MainWindow& TrayIcon::window()
+{
+    if (!mainWindow) {
+        mainWindow = std::make_unique<MainWindow>();
+
+        connect(mainWindow.get(), &MainWindow::hidden, this, [this]() {
+            if (appConfig->get<ConfigKey::LowFootprint>()) {
+                // Still inside the hide event of the window
+                mainWindow.release()->deleteLater();
+            }
+        });
+    }
+
+    return *mainWindow;
+}
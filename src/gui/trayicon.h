@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TRAYICON_H
+#define TRAYICON_H
+
+#include <QObject>
+
+#include <memory>
+
+class MainWindow;
+class QAction;
+class QMenu;
+class QSystemTrayIcon;
+
+/*
+ * System tray entry and owner of the settings window, which is only built
+ * the first time it is shown. In low footprint mode it is destroyed again
+ * when hidden.
+ */
+class TrayIcon : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrayIcon(QObject *parent = nullptr);
+    ~TrayIcon();
+
+    void showWindow();
+    void toggleWindow();
+
+    bool hasWindow() const
+    {
+        return mainWindow != nullptr;
+    }
+
+private:
+    MainWindow& window();
+
+    QSystemTrayIcon *tray;
+    std::unique_ptr<QMenu> menu;
+    QAction *activateAction;
+    std::unique_ptr<MainWindow> mainWindow;
+};
+
+#endif // TRAYICON_H
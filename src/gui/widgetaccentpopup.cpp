@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gui/widgetaccentpopup.h"
+
+#include <QImage>
+
+WidgetAccentPopup::WidgetAccentPopup(QObject *parent)
+    : AccentPopup(parent)
+{
+    // Never takes the focus; keys arrive through KeyMonitor instead
+    window.setWindowFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint
+                          | Qt::WindowDoesNotAcceptFocus);
+    window.setAttribute(Qt::WA_TranslucentBackground);
+    window.setAttribute(Qt::WA_ShowWithoutActivating);
+
+    connect(&window, &AccentStrip::hovered, this, &AccentPopup::hovered);
+    connect(&window, &AccentStrip::clicked, this, &AccentPopup::clicked);
+}
+
+void WidgetAccentPopup::realize(const QStringList &accents)
+{
+    // Realizes the ARGB native window now instead of on the first show
+    window.ensurePolished();
+    window.winId();
+
+    window.warm(accents);
+
+    // Goes through layout and painting once off screen
+    window.setAccents(accents.mid(0, 8));
+    window.adjustSize();
+
+    const qreal ratio = window.devicePixelRatioF();
+    QImage image(window.size() * ratio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(ratio);
+    image.fill(Qt::transparent);
+    window.render(&image);
+
+    window.clear();
+}
+
+void WidgetAccentPopup::setAccents(const QStringList &accents, const QString &header)
+{
+    window.setAccents(accents, header);
+    window.adjustSize();
+}
+
+void WidgetAccentPopup::setCurrentIndex(int index)
+{
+    window.setCurrentIndex(index);
+}
+
+QSize WidgetAccentPopup::size() const
+{
+    return window.size();
+}
+
+void WidgetAccentPopup::move(const QPoint &pos)
+{
+    window.move(pos);
+}
+
+void WidgetAccentPopup::show()
+{
+    window.show();
+}
+
+void WidgetAccentPopup::hide()
+{
+    window.hide();
+    window.clear();
+}
+
+bool WidgetAccentPopup::isVisible() const
+{
+    return window.isVisible();
+}
+
+qint64 WidgetAccentPopup::memoryUsage() const
+{
+    return window.memoryUsage();
+}
+
+void WidgetAccentPopup::releaseResources()
+{
+    if (!window.isVisible()) {
+        window.releaseResources();
+    }
+}
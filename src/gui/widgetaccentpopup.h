@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef WIDGETACCENTPOPUP_H
+#define WIDGETACCENTPOPUP_H
+
+#include "gui/accentpopup.h"
+#include "gui/accentstrip.h"
+
+// Popup backed by a translucent top level Qt widget
+class WidgetAccentPopup : public AccentPopup
+{
+    Q_OBJECT
+
+public:
+    explicit WidgetAccentPopup(QObject *parent = nullptr);
+
+    void realize(const QStringList &accents) override;
+
+    void setAccents(const QStringList &accents, const QString &header = QString()) override;
+    void setCurrentIndex(int index) override;
+    QSize size() const override;
+
+    void move(const QPoint &pos) override;
+    void show() override;
+    void hide() override;
+    bool isVisible() const override;
+
+    qint64 memoryUsage() const override;
+    void releaseResources() override;
+
+private:
+    AccentStrip window;
+};
+
+#endif // WIDGETACCENTPOPUP_H
@@ -1,58 +1,220 @@
-#include <QSharedMemory>
 #include <QApplication>
-#include <QMenu>
+#include <QCommandLineParser>
 #include <QMessageBox>
-#include <QSystemTrayIcon>
+#include <QTimer>
+
+#include <cstdio>
 
 #include "gui/accentpicker.h"
 #include "config/appconfig.h"
 #include "config/configkeys.h"
 #include "core/keymonitor.h"
-#include "gui/mainwindow.h"
+#include "core/accentmap.h"
+#include "core/composeaccents.h"
+#include "core/customaccents.h"
 #include "core/singleinstance.h"
+#include "core/controlclient.h"
+#include "core/startupprofile.h"
+#include "gui/controlcommands.h"
+#include "gui/trayicon.h"
+
+namespace
+{
+const QString InstanceKey = QStringLiteral("accentpicker");
+
+// Prints the details of the running instance's replies, returns the exit status
+int printReplies(const QByteArrayList &replies)
+{
+    for (const QByteArray &reply : replies) {
+        if (!reply.startsWith("ok")) {
+            qWarning().noquote() << QString::fromUtf8(reply);
+            return 1;
+        }
+        if (reply.size() > 3) {
+            std::printf("%s\n", reply.mid(3).constData());
+        }
+    }
+    return 0;
+}
+}
 
 int main(int argc, char *argv[])
 {
+    // Scripted control of the running instance, without starting a GUI
+    if (argc > 1 && qstrcmp(argv[1], "--ctl") == 0) {
+        QStringList arguments;
+        for (int i = 2; i < argc; ++i) {
+            arguments << QString::fromLocal8Bit(argv[i]);
+        }
+        return ControlClient::run(InstanceKey, arguments);
+    }
+
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments << QString::fromLocal8Bit(argv[i]);
+    }
+
+    QCommandLineParser parser;
+    const QCommandLineOption helpOption = parser.addHelpOption();
+    const QCommandLineOption showOption("show", "Show the settings window of the running instance.");
+    const QCommandLineOption toggleOption("toggle", "Activate or deactivate the running instance.");
+    const QCommandLineOption reloadOption("reload", "Make the running instance reload its settings and tables.");
+    const QCommandLineOption insertOption("insert", "Paste <text> into the focused window.", "text");
+    const QCommandLineOption profileOption("startup-profile", "Print how long each start up phase takes.");
+    const QCommandLineOption memoryOption("report-memory", "Print the memory use of the running instance, "
+                                          "or of this one once it is started.");
+    parser.addOptions({showOption, toggleOption, reloadOption, insertOption, profileOption, memoryOption});
+
+    // Errors and --help are left to process() once QApplication exists
+    const bool parsed = parser.parse(arguments) && !parser.isSet(helpOption)
+                        && !parser.optionNames().contains(QStringLiteral("help-all"));
+
+    QByteArrayList commands;
+    if (parser.isSet(showOption)) {
+        commands << "show";
+    }
+    if (parser.isSet(toggleOption)) {
+        commands << "toggle";
+    }
+    if (parser.isSet(reloadOption)) {
+        commands << "reload";
+    }
+    if (parser.isSet(insertOption)) {
+        commands << "insert " + parser.value(insertOption).toUtf8();
+    }
+
+    // A plain second launch brings up the running instance
+    QByteArrayList forwarded = commands;
+    if (parser.isSet(memoryOption)) {
+        forwarded << "memory";
+    } else if (forwarded.isEmpty()) {
+        forwarded << "show";
+    }
+
+    // A second launch only forwards its commands, so it is tried before
+    // paying for a QApplication
+    if (parsed) {
+        if (const auto replies = SingleInstance::send(InstanceKey, forwarded)) {
+            return printReplies(*replies);
+        }
+    }
+
+    // Checked before QApplication so that its construction is measured too
+    if (parsed && parser.isSet(profileOption)) {
+        StartupProfile::start();
+    }
+
     QApplication app(argc, argv);
     app.setQuitOnLastWindowClosed(false);
 
-    SingleInstance instance("AccentPickerSingletonKey");
+    QCoreApplication::setOrganizationName("HBatalha");
+    QCoreApplication::setApplicationName("Accent Picker");
+    StartupProfile::mark("QApplication");
+
+    parser.process(app);
+
+    SingleInstance instance(InstanceKey);
 
     if(!instance.run()) {
-        QMessageBox::warning(nullptr, "Accent Picker",
-                             "Another instance is already running.");
-        return 1;
+        // Another instance started since the first attempt
+        const auto replies = SingleInstance::send(InstanceKey, forwarded);
+        if (!replies) {
+            QMessageBox::warning(nullptr, "Accent Picker",
+                                 "Another instance is already running but does not respond.");
+            return 1;
+        }
+
+        return printReplies(*replies);
     }
 
-    QCoreApplication::setOrganizationName("HBatalha");
-    QCoreApplication::setApplicationName("Accent Picker");
+    appConfig->watch();
+    StartupProfile::mark("settings");
 
-    AccentPicker picker;
+    // Recording starts on its own thread while the rest is built; the
+    // events are queued until the event loop runs
     KeyMonitor monitor;
+    QObject::connect(&monitor, &KeyMonitor::recording, []() {
+        StartupProfile::mark("monitor recording");
+    });
+
+    if (appConfig->get<ConfigKey::Active>()) {
+        if (!monitor.start()) {
+            QMessageBox::critical(nullptr, "Error",
+                                  "Failed to start keyboard monitoring.");
+            return 1;
+        }
+    }
+
+    appConfig->onChanged<ConfigKey::Active>(&monitor, [&monitor](bool active) {
+        monitor.setActive(active);
+    });
+    StartupProfile::mark("monitor started");
+
+    QObject::connect(customAccents, &CustomAccents::reloaded, []() {
+        AccentMap::clearCache();
+    });
+    appConfig->onChanged<ConfigKey::SelectedAllCharacterSets>(&app, [](bool) {
+        AccentMap::clearCache();
+    });
+    appConfig->onChanged<ConfigKey::SelectedCharacterSets>(&app, [](const QStringList &) {
+        AccentMap::clearCache();
+    });
+    customAccents->load();
+    composeAccents->load();
+    StartupProfile::mark("accent tables");
+
+    AccentPicker picker;
 
     QObject::connect(&monitor, &KeyMonitor::keyEvent,
                      &picker, &AccentPicker::keyEvent);
 
+    QObject::connect(&monitor, &KeyMonitor::prepareAccents,
+                     &picker, &AccentPicker::prepareAccents);
+
+    QObject::connect(&monitor, &KeyMonitor::discardAccents,
+                     &picker, &AccentPicker::discardAccents);
+
+    QObject::connect(&monitor, &KeyMonitor::navigationKey,
+                     &picker, &AccentPicker::navigate);
+
     QObject::connect(&picker, &AccentPicker::visibleChanged,
                      &monitor, &KeyMonitor::accentPickerVisible);
 
     QObject::connect(&picker, &AccentPicker::accentSelected,
                      &monitor, &KeyMonitor::insertText);
+    StartupProfile::mark("picker");
 
-    MainWindow mainWindow(&monitor);
+    // The settings window is built on first use
+    TrayIcon tray;
+    StartupProfile::mark("tray icon");
 
-    if (appConfig->get<ConfigKey::Active>()) {
-        if (!monitor.start()) {
-            QMessageBox::critical(nullptr, "Error",
-                                  "Failed to start keyboard monitoring.");
-            return 1;
-        }
-    }
+    ControlCommands control(&picker, &monitor, &tray);
+    instance.setHandler([&control](const QByteArray &command) {
+        return control.execute(command);
+    });
 
     if (!appConfig->get<ConfigKey::StartHidden>()) {
-        mainWindow.show();
+        tray.showWindow();
+        StartupProfile::mark("main window");
+    }
+
+    // Commands given to the first instance apply to itself
+    for (const QByteArray &command : std::as_const(commands)) {
+        control.execute(command);
     }
 
+    // Realize the popup once the event loop is idle rather than on first use
+    const bool reportMemory = parser.isSet(memoryOption);
+    QTimer::singleShot(0, &picker, [&picker, &control, reportMemory]() {
+        StartupProfile::mark("event loop");
+        picker.prepare();
+        StartupProfile::mark("popup prepared");
+
+        if (reportMemory) {
+            std::printf("%s\n", control.execute("memory").mid(3).constData());
+            std::fflush(stdout);
+        }
+    });
+
     return app.exec();
 }
-
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "platform/x11/caretlocator.h"
+
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+
+#include "platform/x11/x11platformwindow.h"
+
+namespace
+{
+constexpr int LookupTimeout = 100; // ms
+constexpr int MaxCachedWindows = 64;
+constexpr int ScreenCoordinates = 0; // ATSPI_COORD_TYPE_SCREEN
+
+const QString BusConnectionName = QStringLiteral("accentpicker-atspi");
+}
+
+CaretLocator::CaretLocator(QObject *parent)
+    : QObject(parent), bus(QString()), activeWindow(0), focusWindow(0)
+{
+    const QString address = QString::fromLocal8Bit(qgetenv("AT_SPI_BUS_ADDRESS"));
+    if (!address.isEmpty()) {
+        connectToBus(address);
+        return;
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(QStringLiteral("org.a11y.Bus"), QStringLiteral("/org/a11y/bus"),
+                        QStringLiteral("org.a11y.Bus"), QStringLiteral("GetAddress"));
+
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(call, LookupTimeout * 10), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        const QDBusPendingReply<QString> reply = *watcher;
+        if (reply.isValid()) {
+            connectToBus(reply.value());
+        } else {
+            qWarning() << "AT-SPI bus not available:" << reply.error().message();
+        }
+        watcher->deleteLater();
+    });
+}
+
+std::optional<QRect> CaretLocator::cached() const
+{
+    const auto it = carets.constFind(activeWindow);
+    return it != carets.constEnd() ? it->rect : std::nullopt;
+}
+
+void CaretLocator::request()
+{
+    const quint64 window = getCurrentWindow();
+    activeWindow = window;
+    // Applications without accessibility report no focus events
+    focusWindow = window;
+
+    const auto it = carets.constFind(window);
+    if (!bus.isConnected() || it == carets.constEnd() || it->offset < 0) {
+        return;
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(it->service, it->path,
+                        QStringLiteral("org.a11y.atspi.Text"),
+                        QStringLiteral("GetCharacterExtents"));
+    call << it->offset << quint32(ScreenCoordinates);
+
+    const int offset = it->offset;
+    auto *watcher = new QDBusPendingCallWatcher(bus.asyncCall(call, LookupTimeout), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, window, offset](QDBusPendingCallWatcher *watcher) {
+        extentsReceived(watcher, window, offset);
+    });
+}
+
+void CaretLocator::textCaretMoved(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() < 2) {
+        return;
+    }
+
+    if (focusWindow == 0) {
+        focusWindow = getCurrentWindow();
+    }
+
+    const quint64 window = focusWindow;
+    if (window == 0) {
+        return;
+    }
+
+    if (carets.size() >= MaxCachedWindows && !carets.contains(window)) {
+        carets.clear();
+    }
+
+    Caret &caret = carets[window];
+    if (caret.service != message.service() || caret.path != message.path()) {
+        caret.rect.reset();
+    }
+    caret.service = message.service();
+    caret.path = message.path();
+    caret.offset = arguments[1].toInt();
+}
+
+void CaretLocator::stateChanged(const QDBusMessage &message)
+{
+    // object:state-changed:focused with detail1 set when gained
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() < 2 || arguments[0].toString() != QLatin1String("focused") || arguments[1].toInt() != 1) {
+        return;
+    }
+
+    // The window manager may not have updated the active window yet, so
+    // it is looked up with the next caret movement
+    focusWindow = 0;
+}
+
+void CaretLocator::connectToBus(const QString &address)
+{
+    bus = QDBusConnection::connectToBus(address, BusConnectionName);
+    if (!bus.isConnected()) {
+        qWarning() << "Failed to connect to the AT-SPI bus:" << bus.lastError().message();
+        return;
+    }
+
+    bus.connect(QString(), QString(), QStringLiteral("org.a11y.atspi.Event.Object"),
+                QStringLiteral("TextCaretMoved"), this, SLOT(textCaretMoved(QDBusMessage)));
+    bus.connect(QString(), QString(), QStringLiteral("org.a11y.atspi.Event.Object"),
+                QStringLiteral("StateChanged"), this, SLOT(stateChanged(QDBusMessage)));
+
+    // Applications only emit the events some client registered for
+    QDBusMessage registration = QDBusMessage::createMethodCall(QStringLiteral("org.a11y.atspi.Registry"),
+                                QStringLiteral("/org/a11y/atspi/registry"),
+                                QStringLiteral("org.a11y.atspi.Registry"),
+                                QStringLiteral("RegisterEvent"));
+    registration << QStringLiteral("object:text-caret-moved");
+    bus.asyncCall(registration, LookupTimeout * 10);
+
+    QDBusMessage focusRegistration = registration;
+    focusRegistration.setArguments({QStringLiteral("object:state-changed:focused")});
+    bus.asyncCall(focusRegistration, LookupTimeout * 10);
+}
+
+void CaretLocator::extentsReceived(QDBusPendingCallWatcher *watcher, quint64 window, int offset)
+{
+    watcher->deleteLater();
+
+    const QDBusPendingReply<int, int, int, int> reply = *watcher;
+    if (!reply.isValid()) {
+        return;
+    }
+
+    const QRect rect(reply.argumentAt<0>(), reply.argumentAt<1>(), reply.argumentAt<2>(), reply.argumentAt<3>());
+
+    // Some toolkits report (0, 0) for text without layout
+    if (rect.topLeft().isNull() && rect.isEmpty()) {
+        return;
+    }
+
+    auto it = carets.find(window);
+    if (it == carets.end() || it->offset != offset) {
+        return;
+    }
+
+    it->rect = rect;
+
+    if (window == activeWindow) {
+        emit caretFound(rect);
+    }
+}
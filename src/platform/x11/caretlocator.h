@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CARETLOCATOR_H
+#define CARETLOCATOR_H
+
+#include <QDBusConnection>
+#include <QHash>
+#include <QObject>
+#include <QRect>
+
+#include <optional>
+
+class QDBusMessage;
+class QDBusPendingCallWatcher;
+
+/*
+ * Finds the text caret through AT-SPI. Caret movements reported on the
+ * accessibility bus are remembered per focused X window, which is looked
+ * up once with the first movement after a focus change rather than per
+ * movement; request() asks the application for the screen rectangle of
+ * that caret asynchronously and caretFound() is emitted if it answers
+ * within the timeout. Nothing here ever blocks the caller on D-Bus.
+ *
+ * The bus is the one named by $AT_SPI_BUS_ADDRESS when set (e.g. a
+ * private bus), otherwise the one org.a11y.Bus reports on the session bus.
+ */
+class CaretLocator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CaretLocator(QObject *parent = nullptr);
+
+    // Last caret rectangle seen in the active window of the last request(),
+    // in native screen coordinates
+    std::optional<QRect> cached() const;
+
+    // Asks for the caret of the active window
+    void request();
+
+signals:
+    void caretFound(const QRect &rect);
+
+private slots:
+    void textCaretMoved(const QDBusMessage &message);
+    void stateChanged(const QDBusMessage &message);
+
+private:
+    struct Caret {
+        QString service;
+        QString path;
+        int offset = -1;
+        std::optional<QRect> rect;
+    };
+
+    void connectToBus(const QString &address);
+    void extentsReceived(QDBusPendingCallWatcher *watcher, quint64 window, int offset);
+
+    QDBusConnection bus;
+    QHash<quint64, Caret> carets;
+    quint64 activeWindow;
+    // X window of the caret movements since the last focus event, 0 until
+    // the first of them looked it up
+    quint64 focusWindow;
+};
+
+#endif // CARETLOCATOR_H
@@ -0,0 +1,406 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "x11accentpopup.h"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QScreen>
+#include <QSocketNotifier>
+#include <QSysInfo>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <cstdlib>
+
+struct X11AccentPopup::ShmSegment {
+    XShmSegmentInfo info{};
+};
+
+namespace
+{
+// Stands in for the translucent frame of the widget popup on the opaque window
+const QColor BackgroundColor(44, 44, 44);
+
+// Shared memory only works when the server runs on this machine
+bool isLocalDisplay()
+{
+    const QByteArray name = qgetenv("DISPLAY");
+    return name.startsWith(':') || name.startsWith("unix:");
+}
+}
+
+X11AccentPopup* X11AccentPopup::create(QObject *parent)
+{
+    Display *display = XOpenDisplay(nullptr);
+    if (!display) {
+        qWarning() << "Failed to open display for the popup";
+        return nullptr;
+    }
+
+    const int screen = DefaultScreen(display);
+    const Visual *visual = DefaultVisual(display, screen);
+
+    if (DefaultDepth(display, screen) != 24 || visual->c_class != TrueColor
+            || visual->red_mask != 0xff0000 || visual->green_mask != 0x00ff00 || visual->blue_mask != 0x0000ff) {
+        qWarning() << "No 24 bit TrueColor visual for the popup";
+        XCloseDisplay(display);
+        return nullptr;
+    }
+
+    auto *popup = new X11AccentPopup(display, parent);
+    if (!popup->createWindow()) {
+        delete popup;
+        return nullptr;
+    }
+
+    return popup;
+}
+
+X11AccentPopup::X11AccentPopup(Display *display, QObject *parent)
+    : AccentPopup(parent), display(display), window(0), backing(0), gc(nullptr),
+      image(nullptr), notifier(nullptr), ratio(1), visible(false), current(-1)
+{
+    notifier = new QSocketNotifier(ConnectionNumber(display), QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &X11AccentPopup::processEvents);
+
+    connect(&renderer, &AccentStripRenderer::invalidated, this, [this]() {
+        if (!accents.isEmpty() || !header.isEmpty()) {
+            const int index = current;
+            setAccents(QStringList(accents), QString(header));
+            setCurrentIndex(index);
+        }
+    });
+}
+
+X11AccentPopup::~X11AccentPopup()
+{
+    destroyImage();
+
+    if (gc) {
+        XFreeGC(display, gc);
+    }
+
+    if (window) {
+        XDestroyWindow(display, window);
+    }
+
+    XCloseDisplay(display);
+}
+
+void X11AccentPopup::realize(const QStringList &accents)
+{
+    renderer.warm(accents, devicePixelRatio());
+
+    // Allocates the image and the backing pixmap for a typical row
+    setAccents(accents.mid(0, 8));
+    renderer.clear();
+    this->accents.clear();
+    header.clear();
+}
+
+void X11AccentPopup::setAccents(const QStringList &accents, const QString &header)
+{
+    this->accents = accents;
+    this->header = header;
+    ratio = devicePixelRatio();
+    current = -1;
+
+    renderer.setAccents(accents, ratio, header);
+
+    const QSize deviceSize = (QSizeF(renderer.size()) * ratio).toSize();
+    if (!ensureImage(deviceSize)) {
+        return;
+    }
+
+    XResizeWindow(display, window, static_cast<unsigned>(deviceSize.width()),
+                  static_cast<unsigned>(deviceSize.height()));
+    repaint(QRect(QPoint(0, 0), renderer.size()));
+}
+
+void X11AccentPopup::setCurrentIndex(int index)
+{
+    current = index;
+    repaint(renderer.setCurrentIndex(index));
+}
+
+QSize X11AccentPopup::size() const
+{
+    return renderer.size();
+}
+
+void X11AccentPopup::move(const QPoint &pos)
+{
+    position = pos;
+
+    // Assumes the same scale factor on every screen, like the positioning
+    const QPoint native = (QPointF(pos) * ratio).toPoint();
+    XMoveWindow(display, window, native.x(), native.y());
+    XFlush(display);
+}
+
+void X11AccentPopup::show()
+{
+    // The background pixmap already holds the content, so the server
+    // paints it as part of the map
+    XMapRaised(display, window);
+    XFlush(display);
+    visible = true;
+}
+
+void X11AccentPopup::hide()
+{
+    XUnmapWindow(display, window);
+    XFlush(display);
+
+    visible = false;
+    current = -1;
+    accents.clear();
+    header.clear();
+    renderer.clear();
+}
+
+bool X11AccentPopup::isVisible() const
+{
+    return visible;
+}
+
+qint64 X11AccentPopup::memoryUsage() const
+{
+    qint64 bytes = renderer.memoryUsage();
+    if (image) {
+        // The same amount again for the backing pixmap in the server
+        bytes += 2 * static_cast<qint64>(image->bytes_per_line) * image->height;
+    }
+
+    return bytes;
+}
+
+void X11AccentPopup::releaseResources()
+{
+    if (visible) {
+        return;
+    }
+
+    // ensureImage() allocates a new one on the next setAccents()
+    destroyImage();
+    renderer.releaseResources();
+    XFlush(display);
+}
+
+void X11AccentPopup::processEvents()
+{
+    while (XPending(display)) {
+        XEvent event;
+        XNextEvent(display, &event);
+
+        if (event.type == MotionNotify) {
+            const int index = renderer.cellAt((QPointF(event.xmotion.x, event.xmotion.y) / ratio).toPoint());
+            if (index >= 0 && index != current) {
+                emit hovered(index);
+            }
+        } else if (event.type == ButtonPress && event.xbutton.button == Button1) {
+            const int index = renderer.cellAt((QPointF(event.xbutton.x, event.xbutton.y) / ratio).toPoint());
+            if (index >= 0) {
+                emit clicked(index);
+            }
+        }
+    }
+}
+
+bool X11AccentPopup::createWindow()
+{
+    const int screen = DefaultScreen(display);
+
+    XSetWindowAttributes attributes{};
+    attributes.override_redirect = True;
+    attributes.background_pixel = BlackPixel(display, screen);
+    attributes.border_pixel = 0;
+    attributes.save_under = True;
+    attributes.event_mask = ButtonPressMask | PointerMotionMask;
+
+    window = XCreateWindow(display, RootWindow(display, screen), 0, 0, 1, 1, 0,
+                           CopyFromParent, InputOutput, CopyFromParent,
+                           CWOverrideRedirect | CWBackPixel | CWBorderPixel | CWSaveUnder | CWEventMask,
+                           &attributes);
+    if (!window) {
+        qWarning() << "Failed to create the popup window";
+        return false;
+    }
+
+    // Compositors read these even for override-redirect windows
+    const Atom type = XInternAtom(display, "_NET_WM_WINDOW_TYPE_POPUP_MENU", False);
+    XChangeProperty(display, window, XInternAtom(display, "_NET_WM_WINDOW_TYPE", False),
+                    XA_ATOM, 32, PropModeReplace, reinterpret_cast<const unsigned char*>(&type), 1);
+
+    const long bypassCompositor = 1;
+    XChangeProperty(display, window, XInternAtom(display, "_NET_WM_BYPASS_COMPOSITOR", False),
+                    XA_CARDINAL, 32, PropModeReplace, reinterpret_cast<const unsigned char*>(&bypassCompositor), 1);
+
+    XWMHints hints{};
+    hints.flags = InputHint;
+    hints.input = False;
+    XSetWMHints(display, window, &hints);
+
+    XClassHint classHint;
+    classHint.res_name = const_cast<char*>("accentpicker");
+    classHint.res_class = const_cast<char*>("AccentPicker");
+    XSetClassHint(display, window, &classHint);
+    XStoreName(display, window, "Accent Picker");
+
+    gc = XCreateGC(display, window, 0, nullptr);
+    XFlush(display);
+
+    return true;
+}
+
+bool X11AccentPopup::ensureImage(const QSize &deviceSize)
+{
+    if (image && image->width >= deviceSize.width() && image->height >= deviceSize.height()) {
+        return true;
+    }
+
+    // Only grows, so later popups reuse the same image and pixmap
+    const int width = qMax(deviceSize.width(), image ? image->width : 0);
+    const int height = qMax(deviceSize.height(), image ? image->height : 0);
+
+    destroyImage();
+
+    Visual *visual = DefaultVisual(display, DefaultScreen(display));
+
+    if (isLocalDisplay() && XShmQueryExtension(display)) {
+        auto segment = std::make_unique<ShmSegment>();
+        image = XShmCreateImage(display, visual, 24, ZPixmap, nullptr, &segment->info,
+                                static_cast<unsigned>(width), static_cast<unsigned>(height));
+
+        if (image) {
+            segment->info.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(image->bytes_per_line) * image->height,
+                                         IPC_CREAT | 0600);
+            segment->info.shmaddr = segment->info.shmid == -1 ? reinterpret_cast<char*>(-1)
+                                    : static_cast<char*>(shmat(segment->info.shmid, nullptr, 0));
+            segment->info.readOnly = False;
+
+            if (segment->info.shmaddr != reinterpret_cast<char*>(-1) && XShmAttach(display, &segment->info)) {
+                XSync(display, False);
+                // Goes away with the last detach
+                shmctl(segment->info.shmid, IPC_RMID, nullptr);
+                image->data = segment->info.shmaddr;
+                shm = std::move(segment);
+            } else {
+                if (segment->info.shmaddr != reinterpret_cast<char*>(-1)) {
+                    shmdt(segment->info.shmaddr);
+                }
+                if (segment->info.shmid != -1) {
+                    shmctl(segment->info.shmid, IPC_RMID, nullptr);
+                }
+                image->data = nullptr;
+                XDestroyImage(image);
+                image = nullptr;
+            }
+        }
+    }
+
+    if (!image) {
+        char *data = static_cast<char*>(std::malloc(static_cast<size_t>(width) * height * 4));
+        image = XCreateImage(display, visual, 24, ZPixmap, 0, data,
+                             static_cast<unsigned>(width), static_cast<unsigned>(height), 32, 0);
+        if (!image) {
+            std::free(data);
+            return false;
+        }
+    }
+
+    const bool littleEndian = QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+    if (image->bits_per_pixel != 32 || (image->byte_order == LSBFirst) != littleEndian) {
+        qWarning() << "Unsupported image layout for the popup";
+        destroyImage();
+        return false;
+    }
+
+    surface = QImage(reinterpret_cast<uchar*>(image->data), image->width, image->height,
+                     image->bytes_per_line, QImage::Format_RGB32);
+
+    backing = XCreatePixmap(display, window, static_cast<unsigned>(width), static_cast<unsigned>(height), 24);
+    XSetWindowBackgroundPixmap(display, window, backing);
+
+    return true;
+}
+
+void X11AccentPopup::destroyImage()
+{
+    surface = QImage();
+
+    if (backing) {
+        XSetWindowBackground(display, window, BlackPixel(display, DefaultScreen(display)));
+        XFreePixmap(display, backing);
+        backing = 0;
+    }
+
+    if (!image) {
+        return;
+    }
+
+    if (shm) {
+        XShmDetach(display, &shm->info);
+        XSync(display, False);
+        shmdt(shm->info.shmaddr);
+        shm.reset();
+
+        // XDestroyImage would free() the shared memory otherwise
+        image->data = nullptr;
+    }
+
+    XDestroyImage(image);
+    image = nullptr;
+}
+
+void X11AccentPopup::repaint(const QRegion &region)
+{
+    if (surface.isNull() || region.isEmpty()) {
+        return;
+    }
+
+    const QRect exposed = region.boundingRect();
+
+    surface.setDevicePixelRatio(ratio);
+    {
+        QPainter painter(&surface);
+        painter.setClipRegion(region);
+        painter.fillRect(exposed, BackgroundColor);
+        renderer.paint(painter, exposed, ratio);
+    }
+
+    const QRect device = QRectF(QPointF(exposed.topLeft()) * ratio, QSizeF(exposed.size()) * ratio)
+                         .toAlignedRect().intersected(surface.rect());
+
+    if (shm) {
+        XShmPutImage(display, backing, gc, image, device.x(), device.y(), device.x(), device.y(),
+                     static_cast<unsigned>(device.width()), static_cast<unsigned>(device.height()), False);
+    } else {
+        XPutImage(display, backing, gc, image, device.x(), device.y(), device.x(), device.y(),
+                  static_cast<unsigned>(device.width()), static_cast<unsigned>(device.height()));
+    }
+
+    if (visible) {
+        XClearArea(display, window, device.x(), device.y(),
+                   static_cast<unsigned>(device.width()), static_cast<unsigned>(device.height()), False);
+    }
+
+    XFlush(display);
+}
+
+qreal X11AccentPopup::devicePixelRatio() const
+{
+    QScreen *screen = QGuiApplication::screenAt(position);
+    if (!screen) {
+        screen = QGuiApplication::primaryScreen();
+    }
+
+    return screen ? screen->devicePixelRatio() : 1;
+}
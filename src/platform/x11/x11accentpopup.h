@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef X11ACCENTPOPUP_H
+#define X11ACCENTPOPUP_H
+
+#include <QImage>
+#include <QRegion>
+
+#include <memory>
+
+#include "gui/accentpopup.h"
+#include "gui/accentstriprenderer.h"
+
+struct _XDisplay;
+typedef struct _XDisplay Display;
+struct _XGC;
+struct _XImage;
+
+class QSocketNotifier;
+
+/*
+ * Minimal popup: an override-redirect window on a private Xlib
+ * connection, painted in software into a shared memory image (MIT-SHM,
+ * plain XPutImage when the server is not local). The image is copied to
+ * the window's background pixmap, so mapping the window puts the pixels
+ * on screen without waiting for an Expose round trip.
+ */
+class X11AccentPopup : public AccentPopup
+{
+    Q_OBJECT
+
+public:
+    // Returns nullptr when the display has no usable 24 bit TrueColor visual
+    static X11AccentPopup* create(QObject *parent = nullptr);
+    ~X11AccentPopup();
+
+    void realize(const QStringList &accents) override;
+
+    void setAccents(const QStringList &accents, const QString &header = QString()) override;
+    void setCurrentIndex(int index) override;
+    QSize size() const override;
+
+    void move(const QPoint &pos) override;
+    void show() override;
+    void hide() override;
+    bool isVisible() const override;
+
+    qint64 memoryUsage() const override;
+    void releaseResources() override;
+
+private slots:
+    void processEvents();
+
+private:
+    struct ShmSegment;
+
+    X11AccentPopup(Display *display, QObject *parent);
+
+    bool createWindow();
+    bool ensureImage(const QSize &deviceSize);
+    void destroyImage();
+    void repaint(const QRegion &region);
+    qreal devicePixelRatio() const;
+
+    Display *display;
+    unsigned long window;
+    unsigned long backing;
+    _XGC *gc;
+    _XImage *image;
+    std::unique_ptr<ShmSegment> shm;
+    QImage surface;
+    QSocketNotifier *notifier;
+
+    AccentStripRenderer renderer;
+    QStringList accents;
+    QString header;
+    QPoint position;
+    qreal ratio;
+    bool visible;
+    int current;
+};
+
+#endif // X11ACCENTPOPUP_H
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "x11keyboardgrab.h"
+
+#include <QDebug>
+
+#include <X11/Xlib.h>
+
+X11KeyboardGrab::X11KeyboardGrab()
+    : display(nullptr), grabbed(false)
+{
+}
+
+X11KeyboardGrab::~X11KeyboardGrab()
+{
+    release();
+
+    if (display) {
+        XCloseDisplay(display);
+    }
+}
+
+bool X11KeyboardGrab::grab()
+{
+    if (grabbed) {
+        return true;
+    }
+
+    if (!display) {
+        display = XOpenDisplay(nullptr);
+        if (!display) {
+            qWarning() << "Failed to open display for the keyboard grab";
+            return false;
+        }
+    }
+
+    const int result = XGrabKeyboard(display, DefaultRootWindow(display), False,
+                                     GrabModeAsync, GrabModeAsync, CurrentTime);
+    if (result != GrabSuccess) {
+        qWarning() << "Failed to grab the keyboard:" << result;
+        return false;
+    }
+
+    XFlush(display);
+    grabbed = true;
+    return true;
+}
+
+void X11KeyboardGrab::release()
+{
+    if (!grabbed) {
+        return;
+    }
+
+    XUngrabKeyboard(display, CurrentTime);
+    XSync(display, False);
+
+    // The grabbed key events were delivered here and are of no use
+    XEvent event;
+    while (XPending(display)) {
+        XNextEvent(display, &event);
+    }
+
+    grabbed = false;
+}
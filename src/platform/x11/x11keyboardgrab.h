@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef X11KEYBOARDGRAB_H
+#define X11KEYBOARDGRAB_H
+
+struct _XDisplay;
+typedef struct _XDisplay Display;
+
+/*
+ * Active grab of the core keyboard on the root window, held on a private
+ * connection. While it is held key events stop reaching the focused
+ * window (XRecord still sees them) without moving the input focus.
+ */
+class X11KeyboardGrab
+{
+public:
+    X11KeyboardGrab();
+    ~X11KeyboardGrab();
+
+    bool grab();
+    void release();
+
+    bool isGrabbed() const
+    {
+        return grabbed;
+    }
+
+private:
+    Display *display;
+    bool grabbed;
+
+    X11KeyboardGrab(const X11KeyboardGrab &) = delete;
+    X11KeyboardGrab &operator=(const X11KeyboardGrab &) = delete;
+};
+
+#endif // X11KEYBOARDGRAB_H
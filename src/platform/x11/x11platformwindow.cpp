@@ -211,9 +211,9 @@ void X11PlatformWindow::raise()
     }
 }
 
-void X11PlatformWindow::pasteClipboard()
+void X11PlatformWindow::pasteClipboard(bool focusWindow)
 {
-    sendKeyPress(XK_Shift_L, XK_Insert);
+    sendKeyPress(XK_Shift_L, XK_Insert, focusWindow);
 }
 
 bool X11PlatformWindow::isValid() const
@@ -237,18 +237,20 @@ bool X11PlatformWindow::waitForFocus(int ms)
     return m_window == getCurrentWindow();
 }
 
-void X11PlatformWindow::sendKeyPress(int modifier, int key)
+void X11PlatformWindow::sendKeyPress(int modifier, int key, bool focusWindow)
 {
-    Q_ASSERT( isValid() );
-
-    if ( !waitForFocus(20) ) {
-        raise();
-        if ( !waitForFocus(150) ) {
-            return;
+    if (focusWindow) {
+        Q_ASSERT( isValid() );
+
+        if ( !waitForFocus(20) ) {
+            raise();
+            if ( !waitForFocus(150) ) {
+                return;
+            }
         }
-    }
 
-    waitMs(50);
+        waitMs(50);
+    }
 
     if (!x11Application)
         return;
@@ -17,14 +17,16 @@ public:
 
     void raise() ;
 
-    void pasteClipboard() ;
+    // With focusWindow false the paste goes to whatever window has the
+    // focus, without raising this one and waiting for it first
+    void pasteClipboard(bool focusWindow = true) ;
 
     bool isValid() const;
 
 private:
     bool waitForFocus(int ms);
 
-    void sendKeyPress(int modifier, int key);
+    void sendKeyPress(int modifier, int key, bool focusWindow);
 
     Window m_window;
 
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/*
+ * Counts the heap allocations made by any thread while an instance is
+ * alive: malloc, calloc, realloc, the aligned variants and operator new
+ * are replaced for the whole test binary. Only available with
+ * glibc, which exports the __libc_* functions they forward to.
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    quint64 count() const;
+
+    static bool isAvailable();
+
+private:
+    Q_DISABLE_COPY(AllocationCounter)
+};
+
+#endif // ALLOCATIONCOUNTER_H
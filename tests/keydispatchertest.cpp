@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QChar>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <thread>
+
+#include "core/accentmap.h"
+#include "core/composeaccents.h"
+#include "core/customaccents.h"
+#include "core/keydispatcher.h"
+#include "allocationcounter.h"
+
+namespace
+{
+constexpr int SpaceKeycode = 65;
+
+// Heap allocations allowed once warmed up, for a typed letter that does
+// not trigger (press and release) and for a hold, trigger, selection and
+// release. The popup show is timed and counted by accentpicker_popup_bench.
+constexpr quint64 KeystrokeAllocationBudget = 0;
+constexpr quint64 TriggerAllocationBudget = 0;
+
+int keycodeOf(QChar c)
+{
+    return c == u' ' ? SpaceKeycode : 10 + c.unicode() % 80;
+}
+
+// Stands in for the record thread and for AccentPicker around a
+// KeyDispatcher; every event takes the eventfd hop through the event loop
+struct KeyPath {
+    KeyDispatcher dispatcher;
+    int triggers = 0;
+    int navigations = 0;
+
+    KeyPath()
+    {
+        dispatcher.setSpaceKeycode(SpaceKeycode);
+
+        QObject::connect(&dispatcher, &KeyDispatcher::triggered, &dispatcher, [this](char32_t character) {
+            // What AccentPicker looks up for the popup
+            triggers += !AccentMap::getAccents(character, AccentMap::selectedLanguages()).isEmpty();
+            dispatcher.setPickerVisible(true);
+        });
+        QObject::connect(&dispatcher, &KeyDispatcher::released, &dispatcher, [this]() {
+            dispatcher.setPickerVisible(false);
+        });
+        QObject::connect(&dispatcher, &KeyDispatcher::prepareAccents, &dispatcher, [](char32_t character) {
+            AccentMap::getAccents(character, AccentMap::selectedLanguages());
+        });
+        QObject::connect(&dispatcher, &KeyDispatcher::navigate, &dispatcher, [this]() {
+            ++navigations;
+        });
+    }
+
+    void push(int keycode, char32_t character, bool pressed)
+    {
+        KeyEventQueue::Event event;
+        event.keycode = keycode;
+        event.character = character;
+        event.pressed = pressed;
+        dispatcher.eventQueue()->push(event);
+    }
+
+    void key(int keycode, char32_t character, bool pressed)
+    {
+        push(keycode, character, pressed);
+        QCoreApplication::processEvents();
+    }
+
+    // What the record thread's callback pushes once X resolved the keysym;
+    // Latin-1 keysyms equal their code point
+    void record(QChar c, bool pressed)
+    {
+        dispatcher.eventQueue()->pushKey(keycodeOf(c), pressed, c.unicode());
+        QCoreApplication::processEvents();
+    }
+
+    void typeRecorded(const QString &text)
+    {
+        for (const QChar c : text) {
+            record(c, true);
+            record(c, false);
+        }
+    }
+
+    void type(const QString &text)
+    {
+        for (const QChar c : text) {
+            key(keycodeOf(c), c.unicode(), true);
+            key(keycodeOf(c), c.unicode(), false);
+        }
+    }
+
+    // Holds base, waits for the dwell, presses Space, moves the selection
+    // and releases base
+    void trigger(QChar base)
+    {
+        key(keycodeOf(base), base.unicode(), true);
+        dispatcher.dwellElapsed();
+        key(SpaceKeycode, U' ', true);
+        key(SpaceKeycode, U' ', false);
+        key(SpaceKeycode, U' ', true);
+        key(SpaceKeycode, U' ', false);
+        key(keycodeOf(base), base.unicode(), false);
+    }
+};
+}
+
+/*
+ * The key path from the record thread's queue to the picker, without
+ * X11: what the dispatcher emits for a sequence of events and how many
+ * heap allocations a warmed-up keystroke or trigger makes.
+ */
+class KeyDispatcherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void keysymToUcs4();
+    void eventsArriveThroughEventLoop();
+    void eventsFromAnotherThread();
+    void triggerAndNavigate();
+
+    void keystrokeAllocations();
+    void recordedKeystrokeAllocations();
+    void triggerAllocations();
+};
+
+void KeyDispatcherTest::initTestCase()
+{
+    // Default settings and fresh caches instead of the user's
+    QCoreApplication::setOrganizationName("HBatalha");
+    QCoreApplication::setApplicationName("Accent Picker Test");
+    QStandardPaths::setTestModeEnabled(true);
+
+    composeAccents->load();
+    customAccents->load();
+}
+
+void KeyDispatcherTest::keysymToUcs4()
+{
+    QCOMPARE(KeyEventQueue::keysymToUcs4(0x0061), U'a');
+    QCOMPARE(KeyEventQueue::keysymToUcs4(0x00e9), U'é');
+    QCOMPARE(KeyEventQueue::keysymToUcs4(0x01000101), U'\u0101');
+    // BackSpace and Shift_L
+    QCOMPARE(KeyEventQueue::keysymToUcs4(0xff08), U'\0');
+    QCOMPARE(KeyEventQueue::keysymToUcs4(0xffe1), U'\0');
+}
+
+void KeyDispatcherTest::eventsArriveThroughEventLoop()
+{
+    KeyPath path;
+
+    path.push(keycodeOf(u'e'), U'e', true);
+    path.push(SpaceKeycode, U' ', true);
+    QCOMPARE(path.triggers, 0);
+
+    QCoreApplication::processEvents();
+    QCOMPARE(path.triggers, 1);
+    QVERIFY(path.dispatcher.isPickerVisible());
+}
+
+// The record thread is the producer of the queue
+void KeyDispatcherTest::eventsFromAnotherThread()
+{
+    KeyPath path;
+
+    std::thread producer([&path]() {
+        path.dispatcher.eventQueue()->pushKey(keycodeOf(u'e'), true, U'e');
+        path.dispatcher.eventQueue()->pushKey(SpaceKeycode, true, U' ');
+    });
+    producer.join();
+
+    QTRY_COMPARE(path.triggers, 1);
+}
+
+void KeyDispatcherTest::triggerAndNavigate()
+{
+    KeyPath path;
+
+    path.type(QStringLiteral("abc"));
+    QCOMPARE(path.triggers, 0);
+
+    path.trigger(u'e');
+    QCOMPARE(path.triggers, 1);
+    // Only the second Space press is for the picker
+    QCOMPARE(path.navigations, 1);
+    QVERIFY(!path.dispatcher.isPickerVisible());
+}
+
+void KeyDispatcherTest::keystrokeAllocations()
+{
+    if (!AllocationCounter::isAvailable()) {
+        QSKIP("Allocations are only counted with glibc");
+    }
+
+    const QString text = QStringLiteral("the quick brown fox jumps over the lazy dog");
+
+    KeyPath path;
+    path.type(text);
+
+    quint64 allocations = 0;
+    {
+        AllocationCounter counter;
+        path.type(text);
+        allocations = counter.count();
+    }
+
+    QVERIFY2(allocations <= KeystrokeAllocationBudget * text.size(),
+             qPrintable(QStringLiteral("%1 allocations for %2 keystrokes").arg(allocations).arg(text.size())));
+}
+
+// The same through the record callback's translation of the keysym
+void KeyDispatcherTest::recordedKeystrokeAllocations()
+{
+    if (!AllocationCounter::isAvailable()) {
+        QSKIP("Allocations are only counted with glibc");
+    }
+
+    const QString text = QStringLiteral("the quick brown fox jumps over the lazy dog");
+
+    KeyPath path;
+    path.typeRecorded(text);
+
+    quint64 allocations = 0;
+    {
+        AllocationCounter counter;
+        path.typeRecorded(text);
+        allocations = counter.count();
+    }
+
+    QVERIFY2(allocations <= KeystrokeAllocationBudget * text.size(),
+             qPrintable(QStringLiteral("%1 allocations for %2 keystrokes").arg(allocations).arg(text.size())));
+}
+
+void KeyDispatcherTest::triggerAllocations()
+{
+    if (!AllocationCounter::isAvailable()) {
+        QSKIP("Allocations are only counted with glibc");
+    }
+
+    KeyPath path;
+    path.trigger(u'e');
+
+    quint64 allocations = 0;
+    {
+        AllocationCounter counter;
+        path.trigger(u'e');
+        allocations = counter.count();
+    }
+
+    QCOMPARE(path.triggers, 2);
+    QVERIFY2(allocations <= TriggerAllocationBudget,
+             qPrintable(QStringLiteral("%1 allocations for a trigger").arg(allocations)));
+}
+
+QTEST_GUILESS_MAIN(KeyDispatcherTest)
+
+#include "keydispatchertest.moc"
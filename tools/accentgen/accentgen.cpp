@@ -0,0 +1,619 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * Build time generator for the accent tables used by AccentMap.
+ *
+ *   accentgen <UnicodeData.txt> <accentsets.txt> <tables header> <names header>
+ *
+ * Every precomposed letter whose canonical decomposition starts with a
+ * given base letter is collected into the "UNI" set; the language sets
+ * from accentsets.txt are emitted next to it as lists over the same
+ * string pool. Each list has a lower and an upper case column, so the
+ * popup never converts case at runtime; sets marked "case=turkic" map
+ * i/ı to İ/I. Bases are looked up through a two-stage page table, see
+ * core/codepointtable.h.
+ *
+ * The names header indexes the Unicode names of every single character
+ * candidate for the popup search: the lower cased names in one pool and
+ * a suffix array over the start of every word in it.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+constexpr char32_t MaxCodePoint = 0x10FFFF;
+constexpr int PageBits = 8;
+constexpr int PageSize = 1 << PageBits;
+constexpr int PageCount = (MaxCodePoint + 1) >> PageBits;
+
+using CodePoints = std::u32string;
+
+struct CharInfo {
+    std::string name;
+    std::string category;
+    CodePoints decomposition; // canonical only
+    char32_t upper = 0;       // simple upper case mapping, 0 if none
+};
+
+enum class CaseRules {
+    Default,
+    Turkic, // dotted and dotless i are separate letters
+};
+
+struct AccentSet {
+    std::string code;
+    CaseRules caseRules = CaseRules::Default;
+    std::map<char32_t, std::vector<CodePoints>> entries;
+};
+
+using CharacterData = std::map<char32_t, CharInfo>;
+
+[[noreturn]] void fail(const std::string &message)
+{
+    std::cerr << "accentgen: " << message << std::endl;
+    std::exit(1);
+}
+
+std::vector<std::string> split(const std::string &text, char separator)
+{
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(text);
+
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    if (!text.empty() && text.back() == separator) {
+        fields.emplace_back();
+    }
+
+    return fields;
+}
+
+char32_t parseHex(const std::string &text)
+{
+    return static_cast<char32_t>(std::stoul(text, nullptr, 16));
+}
+
+CharacterData readUnicodeData(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fail("cannot open " + path);
+    }
+
+    CharacterData characters;
+    std::string line;
+
+    while (std::getline(file, line)) {
+        const auto fields = split(line, ';');
+        if (fields.size() < 15) {
+            continue;
+        }
+
+        CharInfo info;
+        info.category = fields[2];
+        // Ranges and controls have <placeholder> names
+        if (!fields[1].empty() && fields[1][0] != '<') {
+            info.name = fields[1];
+        }
+        if (!fields[12].empty()) {
+            info.upper = parseHex(fields[12]);
+        }
+
+        // Compatibility decompositions carry a <tag> and are not accents
+        if (!fields[5].empty() && fields[5][0] != '<') {
+            std::istringstream decomposition(fields[5]);
+            std::string part;
+            while (decomposition >> part) {
+                info.decomposition.push_back(parseHex(part));
+            }
+        }
+
+        characters[parseHex(fields[0])] = info;
+    }
+
+    return characters;
+}
+
+CodePoints fullDecomposition(const CharacterData &characters, char32_t codePoint)
+{
+    auto it = characters.find(codePoint);
+    if (it == characters.end() || it->second.decomposition.empty()) {
+        return CodePoints(1, codePoint);
+    }
+
+    CodePoints result;
+    for (char32_t part : it->second.decomposition) {
+        result += fullDecomposition(characters, part);
+    }
+
+    return result;
+}
+
+bool isLetter(const CharacterData &characters, char32_t codePoint)
+{
+    auto it = characters.find(codePoint);
+    return it != characters.end() && it->second.category[0] == 'L';
+}
+
+bool isUpperOrTitle(const CharacterData &characters, char32_t codePoint)
+{
+    auto it = characters.find(codePoint);
+    return it != characters.end() && (it->second.category == "Lu" || it->second.category == "Lt");
+}
+
+AccentSet decompositionSet(const CharacterData &characters)
+{
+    AccentSet set;
+    set.code = "UNI";
+
+    for (const auto &[codePoint, info] : characters) {
+        if (info.decomposition.empty() || !isLetter(characters, codePoint)
+                || isUpperOrTitle(characters, codePoint)) {
+            continue;
+        }
+
+        const char32_t base = fullDecomposition(characters, codePoint)[0];
+        if (isLetter(characters, base) && !isUpperOrTitle(characters, base)) {
+            set.entries[base].push_back(CodePoints(1, codePoint));
+        }
+    }
+
+    return set;
+}
+
+CodePoints decodeUtf8(const std::string &text)
+{
+    CodePoints result;
+
+    for (size_t i = 0; i < text.size();) {
+        const auto lead = static_cast<unsigned char>(text[i]);
+        int length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        char32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+
+        if (i + length > text.size()) {
+            fail("truncated UTF-8 sequence in \"" + text + "\"");
+        }
+
+        for (int k = 1; k < length; ++k) {
+            codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+
+        result.push_back(codePoint);
+        i += length;
+    }
+
+    return result;
+}
+
+CodePoints decodeToken(const std::string &token)
+{
+    std::string literal;
+    CodePoints result;
+
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (token[i] != '\\' || i + 1 == token.size()) {
+            literal += token[i];
+            continue;
+        }
+
+        result += decodeUtf8(literal);
+        literal.clear();
+
+        if (token[i + 1] == 'u' && i + 5 < token.size()) {
+            result.push_back(parseHex(token.substr(i + 2, 4)));
+            i += 5;
+        } else {
+            literal += token[++i];
+        }
+    }
+
+    return result + decodeUtf8(literal);
+}
+
+std::vector<AccentSet> readAccentSets(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fail("cannot open " + path);
+    }
+
+    std::vector<AccentSet> sets;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+
+        std::istringstream stream(line);
+        std::string token;
+        if (!(stream >> token) || token[0] == '#') {
+            continue;
+        }
+
+        if (token.front() == '[' && token.back() == ']') {
+            sets.push_back({token.substr(1, token.size() - 2), CaseRules::Default, {}});
+
+            while (stream >> token) {
+                if (token == "case=turkic") {
+                    sets.back().caseRules = CaseRules::Turkic;
+                } else {
+                    fail(path + ":" + std::to_string(lineNumber) + ": unknown set option " + token);
+                }
+            }
+            continue;
+        }
+
+        if (sets.empty()) {
+            fail(path + ":" + std::to_string(lineNumber) + ": entry outside of a set");
+        }
+
+        const CodePoints base = decodeToken(token);
+        if (base.size() != 1) {
+            fail(path + ":" + std::to_string(lineNumber) + ": base must be a single character");
+        }
+
+        auto &candidates = sets.back().entries[base[0]];
+        while (stream >> token) {
+            const CodePoints candidate = decodeToken(token);
+            if (std::find(candidates.begin(), candidates.end(), candidate) == candidates.end()) {
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    return sets;
+}
+
+std::u16string toUtf16(const CodePoints &codePoints)
+{
+    std::u16string result;
+
+    for (char32_t c : codePoints) {
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            result.push_back(static_cast<char16_t>(0xD800 + (c >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + (c & 0x3FF)));
+        } else {
+            result.push_back(static_cast<char16_t>(c));
+        }
+    }
+
+    return result;
+}
+
+CodePoints toUpper(const CharacterData &characters, const CodePoints &text, CaseRules rules)
+{
+    CodePoints result;
+
+    for (char32_t c : text) {
+        if (rules == CaseRules::Turkic && c == U'i') {
+            result.push_back(U'\u0130');
+            continue;
+        }
+        if (rules == CaseRules::Turkic && c == U'\u0131') {
+            result.push_back(U'I');
+            continue;
+        }
+
+        auto it = characters.find(c);
+        result.push_back(it != characters.end() && it->second.upper ? it->second.upper : c);
+    }
+
+    return result;
+}
+
+template<typename T, typename Format>
+void writeArray(std::ostream &out, const std::string &declaration, const std::vector<T> &values, Format format)
+{
+    out << "inline constexpr " << declaration << "[] = {";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i % 12 == 0 ? "\n    " : " ") << format(values[i]) << ",";
+    }
+    out << "\n};\n\n";
+}
+
+class Generator
+{
+public:
+    Generator(const CharacterData &characters, const std::vector<AccentSet> &sets)
+        : characters(characters), sets(sets)
+    {}
+
+    void write(std::ostream &out)
+    {
+        std::set<char32_t> bases;
+        for (const auto &set : sets) {
+            for (const auto &entry : set.entries) {
+                bases.insert(entry.first);
+            }
+        }
+
+        std::vector<uint16_t> baseSetLists;
+        std::vector<SetList> setLists;
+        std::vector<uint16_t> lists;
+        std::vector<uint16_t> upperLists;
+        std::vector<char32_t> baseCodePoints(bases.begin(), bases.end());
+
+        for (char32_t base : baseCodePoints) {
+            baseSetLists.push_back(checked(setLists.size()));
+
+            for (size_t s = 0; s < sets.size(); ++s) {
+                auto it = sets[s].entries.find(base);
+                if (it == sets[s].entries.end() || it->second.empty()) {
+                    continue;
+                }
+
+                setLists.push_back({checked<uint8_t>(s), checked<uint8_t>(it->second.size()),
+                                    checked(lists.size())});
+                for (const CodePoints &candidate : it->second) {
+                    lists.push_back(stringId(candidate));
+                    upperLists.push_back(stringId(toUpper(characters, candidate, sets[s].caseRules)));
+                }
+            }
+        }
+        baseSetLists.push_back(checked(setLists.size()));
+
+        std::vector<uint16_t> stage1(PageCount, 0);
+        std::vector<uint16_t> stage2(PageSize, 0);
+        for (size_t b = 0; b < baseCodePoints.size(); ++b) {
+            const char32_t base = baseCodePoints[b];
+            uint16_t &page = stage1[base >> PageBits];
+            if (page == 0) {
+                page = checked(stage2.size() / PageSize);
+                stage2.resize(stage2.size() + PageSize, 0);
+            }
+            stage2[(static_cast<size_t>(page) << PageBits) | (base & (PageSize - 1))] = checked(b + 1);
+        }
+
+        auto number = [](auto value) {
+            return std::to_string(value);
+        };
+        auto hex = [](auto value) {
+            std::ostringstream stream;
+            stream << "0x" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(value);
+            return stream.str();
+        };
+
+        out << "// Generated by tools/accentgen from data/accentsets.txt and\n"
+            << "// data/unicode/UnicodeData.txt. Do not edit.\n\n"
+            << "#ifndef ACCENTTABLES_H\n#define ACCENTTABLES_H\n\n"
+            << "#include <QtGlobal>\n\n"
+            << "namespace AccentTables\n{\n\n"
+            << "// A candidate: UTF-16 code units in stringPool\n"
+            << "struct StringRef {\n    quint16 offset;\n    quint16 length;\n};\n\n"
+            << "// The candidates one set has for one base, as string ids in both columns of lists\n"
+            << "struct SetList {\n    quint8 set;\n    quint8 count;\n    quint16 offset;\n};\n\n"
+            << "inline constexpr int SetCount = " << sets.size() << ";\n"
+            << "inline constexpr int BaseCount = " << baseCodePoints.size() << ";\n"
+            << "inline constexpr int PageBits = " << PageBits << ";\n\n";
+
+        out << "inline constexpr const char *setCodes[SetCount] = {";
+        for (const auto &set : sets) {
+            out << "\n    \"" << set.code << "\",";
+        }
+        out << "\n};\n\n";
+
+        writeArray(out, "char16_t stringPool", pool, hex);
+
+        out << "inline constexpr StringRef strings[] = {";
+        for (size_t i = 0; i < strings.size(); ++i) {
+            out << (i % 6 == 0 ? "\n    " : " ") << "{" << strings[i].first << ", " << strings[i].second << "},";
+        }
+        out << "\n};\n\n";
+
+        out << "// Column 0 holds the candidates for a lower case base, column 1 for an upper case one\n"
+            << "inline constexpr quint16 lists[2][" << lists.size() << "] = {\n";
+        for (const auto *column : {&lists, &upperLists}) {
+            out << "    {";
+            for (size_t i = 0; i < column->size(); ++i) {
+                out << (i % 12 == 0 ? "\n        " : " ") << (*column)[i] << ",";
+            }
+            out << "\n    },\n";
+        }
+        out << "};\n\n";
+
+        out << "inline constexpr SetList setLists[] = {";
+        for (size_t i = 0; i < setLists.size(); ++i) {
+            out << (i % 4 == 0 ? "\n    " : " ") << "{" << int(setLists[i].set) << ", "
+                << int(setLists[i].count) << ", " << setLists[i].offset << "},";
+        }
+        out << "\n};\n\n";
+
+        out << "// setLists[baseSetLists[b]] .. setLists[baseSetLists[b + 1]] belong to base b\n";
+        writeArray(out, "quint16 baseSetLists", baseSetLists, number);
+        writeArray(out, "char32_t bases", baseCodePoints, hex);
+
+        out << "// Base index + 1 by code point, 0 when the code point is not a base\n";
+        writeArray(out, "quint16 stage1", stage1, number);
+        writeArray(out, "quint16 stage2", stage2, number);
+
+        out << "inline constexpr int findBase(char32_t codePoint)\n{\n"
+            << "    if (codePoint > 0x10FFFF) {\n        return -1;\n    }\n\n"
+            << "    const size_t slot = (static_cast<size_t>(stage1[codePoint >> PageBits]) << PageBits)\n"
+            << "                        | (codePoint & ((1 << PageBits) - 1));\n"
+            << "    return static_cast<int>(stage2[slot]) - 1;\n}\n\n"
+            << "} // namespace AccentTables\n\n#endif // ACCENTTABLES_H\n";
+    }
+
+    // Every candidate that is a single code point, in both cases
+    std::set<char32_t> singleCharacters() const
+    {
+        std::set<char32_t> result;
+        for (const auto &entry : stringIds) {
+            if (entry.first.size() == 1) {
+                result.insert(entry.first[0]);
+            }
+        }
+        return result;
+    }
+
+private:
+    struct SetList {
+        uint8_t set;
+        uint8_t count;
+        uint16_t offset;
+    };
+
+    template<typename T = uint16_t>
+    static T checked(size_t value)
+    {
+        if (value > std::numeric_limits<T>::max()) {
+            fail(sizeof(T) == 1 ? "table too large for 8 bit fields" : "table too large for 16 bit indices");
+        }
+        return static_cast<T>(value);
+    }
+
+    uint16_t stringId(const CodePoints &candidate)
+    {
+        auto it = stringIds.find(candidate);
+        if (it != stringIds.end()) {
+            return it->second;
+        }
+
+        const std::u16string utf16 = toUtf16(candidate);
+        const uint16_t id = checked(strings.size());
+
+        strings.emplace_back(checked(pool.size()), checked(utf16.size()));
+        pool.insert(pool.end(), utf16.begin(), utf16.end());
+        stringIds.emplace(candidate, id);
+
+        return id;
+    }
+
+    const CharacterData &characters;
+    const std::vector<AccentSet> &sets;
+    std::map<CodePoints, uint16_t> stringIds;
+    std::vector<std::pair<uint16_t, uint16_t>> strings;
+    std::vector<char16_t> pool;
+};
+
+void writeNames(std::ostream &out, const CharacterData &characters, const std::set<char32_t> &codePoints)
+{
+    struct Name {
+        char32_t codePoint;
+        uint32_t offset;
+        uint16_t length;
+    };
+
+    std::string pool;
+    std::vector<Name> names;
+    std::vector<uint32_t> wordStarts;
+
+    for (char32_t codePoint : codePoints) {
+        auto it = characters.find(codePoint);
+        if (it == characters.end() || it->second.name.empty()) {
+            continue;
+        }
+
+        std::string name = it->second.name;
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+
+        const auto offset = static_cast<uint32_t>(pool.size());
+        names.push_back({codePoint, offset, static_cast<uint16_t>(name.size())});
+
+        for (size_t i = 0; i < name.size(); ++i) {
+            if (i == 0 || name[i - 1] == ' ' || name[i - 1] == '-') {
+                wordStarts.push_back(offset + static_cast<uint32_t>(i));
+            }
+        }
+
+        // The separator sorts before any letter, so a word is a prefix of its suffix
+        pool += name + '\n';
+    }
+
+    const std::string_view view(pool);
+    std::sort(wordStarts.begin(), wordStarts.end(), [&view](uint32_t a, uint32_t b) {
+        return view.substr(a) < view.substr(b);
+    });
+
+    out << "// Generated by tools/accentgen from data/accentsets.txt and\n"
+        << "// data/unicode/UnicodeData.txt. Do not edit.\n\n"
+        << "#ifndef ACCENTNAMES_H\n#define ACCENTNAMES_H\n\n"
+        << "#include <QtGlobal>\n\n"
+        << "namespace AccentNames\n{\n\n"
+        << "// A lower cased Unicode name in namePool\n"
+        << "struct Name {\n    char32_t codePoint;\n    quint32 offset;\n    quint16 length;\n};\n\n"
+        << "inline constexpr int NameCount = " << names.size() << ";\n"
+        << "inline constexpr int WordCount = " << wordStarts.size() << ";\n\n";
+
+    out << "// Names separated by newlines, in code point order\n"
+        << "inline constexpr char namePool[] =";
+    for (size_t start = 0; start < pool.size();) {
+        const size_t end = pool.find('\n', start);
+        out << "\n    \"" << pool.substr(start, end - start) << "\\n\"";
+        start = end + 1;
+    }
+    out << ";\n\n";
+
+    out << "// By code point; offsets increase with the index\n"
+        << "inline constexpr Name names[NameCount] = {";
+    for (size_t i = 0; i < names.size(); ++i) {
+        out << (i % 4 == 0 ? "\n    " : " ") << "{0x" << std::hex << static_cast<uint32_t>(names[i].codePoint)
+            << std::dec << ", " << names[i].offset << ", " << names[i].length << "},";
+    }
+    out << "\n};\n\n";
+
+    out << "// Offsets of the word starts in namePool, sorted by the text that follows\n";
+    writeArray(out, "quint32 wordSuffixes", wordStarts, [](uint32_t value) {
+        return std::to_string(value);
+    });
+
+    out << "} // namespace AccentNames\n\n#endif // ACCENTNAMES_H\n";
+}
+
+// Leaves the file alone when nothing changed so dependents are not rebuilt
+bool writeIfChanged(const std::string &path, const std::string &content)
+{
+    std::ifstream existing(path, std::ios::binary);
+    std::ostringstream previous;
+    previous << existing.rdbuf();
+    if (existing && previous.str() == content) {
+        return true;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+
+    return static_cast<bool>(out);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 5) {
+        std::cerr << "usage: accentgen <UnicodeData.txt> <accentsets.txt> <tables header> <names header>"
+                  << std::endl;
+        return 1;
+    }
+
+    const auto characters = readUnicodeData(argv[1]);
+
+    std::vector<AccentSet> sets = readAccentSets(argv[2]);
+    sets.push_back(decompositionSet(characters));
+
+    std::ostringstream tables;
+    Generator generator(characters, sets);
+    generator.write(tables);
+
+    std::ostringstream names;
+    writeNames(names, characters, generator.singleCharacters());
+
+    return writeIfChanged(argv[3], tables.str()) && writeIfChanged(argv[4], names.str()) ? 0 : 1;
+}